@@ -16,6 +16,7 @@
 #ifndef BOOST_PROCESS_ALL_HPP
 #define BOOST_PROCESS_ALL_HPP
 
+#include <boost/process/async_wait_for_exit.hpp>
 #include <boost/process/child.hpp>
 #include <boost/process/create_pipe.hpp>
 #include <boost/process/execute.hpp>
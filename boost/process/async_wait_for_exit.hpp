@@ -0,0 +1,51 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+/**
+ * \file boost/process/async_wait_for_exit.hpp
+ *
+ * Defines a function to wait asynchronously for a process to exit.
+ */
+
+#ifndef BOOST_PROCESS_ASYNC_WAIT_FOR_EXIT_HPP
+#define BOOST_PROCESS_ASYNC_WAIT_FOR_EXIT_HPP
+
+#include <boost/process/config.hpp>
+
+#include BOOST_PROCESS_PLATFORM_PROMOTE_PATH(async_wait_for_exit)
+BOOST_PROCESS_PLATFORM_PROMOTE_NAMESPACE(async_wait_for_exit)
+
+#if defined(BOOST_PROCESS_DOXYGEN)
+namespace boost { namespace process {
+
+/**
+ * Waits asynchronously for a process to exit.
+ *
+ * The handler is called when the process has exited. It must have
+ * this signature: <tt>void(const boost::system::error_code&, int_type)</tt>.
+ * The second parameter is the value boost::process::wait_for_exit
+ * would return.
+ *
+ * On Windows the process handle is registered with the I/O service.
+ * On Linux a pidfd is registered with the I/O service, and the process
+ * is reaped with \c waitpid once the pidfd becomes readable. No signal
+ * handler for \c SIGCHLD is required. If the child doesn't own a pidfd
+ * (because the kernel doesn't support \c pidfd_open) the wait is
+ * delegated to \c boost::process::posix::sigchld_service.
+ *
+ * \note This function returns immediately.
+ */
+template <class Process, class Handler>
+void async_wait_for_exit(boost::asio::io_service &io_service,
+    const Process &p, Handler handler);
+
+}}
+#endif
+
+#endif
@@ -27,8 +27,9 @@ namespace boost { namespace process {
 /**
  * Represents a child process.
  *
- * On Windows child is movable but non-copyable. The destructor
- * automatically closes handles to the child process.
+ * child is movable but non-copyable. On Windows the destructor
+ * automatically closes handles to the child process. On Linux the
+ * destructor closes the pidfd.
  */
 struct child
 {
@@ -60,12 +61,23 @@ struct child
      */
     pid_t pid;
 
+    /**
+     * Process file descriptor.
+     *
+     * -1 if the platform doesn't support \c pidfd_open.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    int pidfd;
+
     /**
      * Constructor.
      *
+     * The child takes ownership of \c fd.
+     *
      * \remark <em>POSIX only.</em>
      */
-    explicit child(pid_t p) : pid(p) {}
+    explicit child(pid_t p, int fd = -1) : pid(p), pidfd(fd) {}
 };
 
 }}
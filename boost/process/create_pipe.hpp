@@ -42,6 +42,73 @@ pipe create_pipe();
  */
 pipe create_pipe(boost::system::error_code &ec);
 
+/**
+ * Creates an anonymous pipe with \c pipe2.
+ *
+ * \c flags is a combination of \c O_CLOEXEC, \c O_NONBLOCK and
+ * \c O_DIRECT (packet mode, Linux only). With \c O_CLOEXEC the
+ * pipe ends aren't inherited by child processes started concurrently
+ * by other threads. The initializers which bind file descriptors
+ * clear \c FD_CLOEXEC on the file descriptor in the child process
+ * only. \c O_NONBLOCK applies to both ends of the pipe.
+ *
+ * If \c pipe2 isn't available, \c FD_CLOEXEC and \c O_NONBLOCK
+ * are set with \c fcntl after the pipe has been created.
+ *
+ * \remark <em>POSIX only.</em>
+ *
+ * \throws boost::system::system_error in case of an error
+ */
+pipe create_pipe(int flags);
+
+/**
+ * Creates an anonymous pipe with \c pipe2.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+pipe create_pipe(int flags, boost::system::error_code &ec);
+
+/**
+ * Creates an anonymous pipe with \c pipe2 and sets its capacity.
+ *
+ * The capacity is set with \c F_SETPIPE_SZ and clamped to
+ * <tt>/proc/sys/fs/pipe-max-size</tt>. The kernel rounds it up to a
+ * power of two. Use the overload with \c actual to get the actual
+ * capacity. On platforms other than Linux the capacity is ignored.
+ *
+ * \remark <em>POSIX only.</em>
+ *
+ * \throws boost::system::system_error in case of an error
+ */
+pipe create_pipe(int flags, std::size_t capacity);
+
+/**
+ * Creates an anonymous pipe with \c pipe2 and sets its capacity.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+pipe create_pipe(int flags, std::size_t capacity,
+    boost::system::error_code &ec);
+
+/**
+ * Creates an anonymous pipe with \c pipe2, sets its capacity and
+ * stores the actual capacity in \c actual.
+ *
+ * \remark <em>POSIX only.</em>
+ *
+ * \throws boost::system::system_error in case of an error
+ */
+pipe create_pipe(int flags, std::size_t capacity, std::size_t &actual);
+
+/**
+ * Creates an anonymous pipe with \c pipe2, sets its capacity and
+ * stores the actual capacity in \c actual.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+pipe create_pipe(int flags, std::size_t capacity, std::size_t &actual,
+    boost::system::error_code &ec);
+
 }}
 #endif
 
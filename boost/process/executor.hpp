@@ -36,6 +36,12 @@ namespace boost { namespace process {
  * reference to itself as a parameter. This gives initializers a
  * chance to handle the error.
  *
+ * On POSIX the program is started with \c posix_spawn if all initializers
+ * support it (see \c is_spawnable). Otherwise \c fork and \c execve
+ * are called. On Linux \c vfork is called instead of \c fork if all
+ * initializers are async-signal-safe in the child process (see
+ * \c is_vfork_safe).
+ *
  * \note Library users shouldn't need to use boost::process::executor.
  *       It is recommended to call boost::process::execute which uses
  *       boost::pocess::executor internally.
@@ -167,6 +173,86 @@ struct executor
      */
     char **env;
 
+    /**
+     * File actions passed to \c posix_spawn.
+     *
+     * Only valid while initializers are called with \c on_spawn_setup.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    posix_spawn_file_actions_t *file_actions;
+
+    /**
+     * Attributes passed to \c posix_spawn.
+     *
+     * Only valid while initializers are called with \c on_spawn_setup.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    posix_spawnattr_t *attr;
+
+    /**
+     * Process ID of the child process.
+     *
+     * Valid in the parent while initializers are called with
+     * \c on_fork_success and \c on_spawn_success.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    pid_t pid;
+
+    /**
+     * Step which failed in the child process before \c execve was
+     * called, or \c exec_stage_execve if \c execve failed.
+     *
+     * Valid in the child process while initializers are called with
+     * \c on_exec_error.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    exec_stage failed_stage;
+
+    /**
+     * Error of the step which failed first.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    int failed_errno;
+
+    /**
+     * Reports that a step failed in the child process.
+     *
+     * Initializers call this function from \c on_exec_setup if a
+     * system call fails. \c execve is skipped and \c on_exec_error is
+     * called with \c errno set to the error of the first failed step.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    void exec_failed(exec_stage stage);
+
+    /**
+     * Closes a file descriptor in the child process started with
+     * \c posix_spawn.
+     *
+     * Initializers call this function from \c on_spawn_setup. The file
+     * descriptors are closed after all file actions added by other
+     * initializers, so file descriptors which are bound with \c dup2 can
+     * be closed no matter in which order initializers are passed.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    void spawn_close(int fd);
+
+    /**
+     * Description of the program to be started by a fork server.
+     *
+     * Only valid while initializers are called with
+     * \c on_fork_server_setup.
+     *
+     * \remark <em>Linux only.</em>
+     */
+    fork_server_request *request;
+
     ///@}
 };
 
@@ -24,6 +24,33 @@ BOOST_PROCESS_PLATFORM_PROMOTE_INITIALIZERS_NAMESPACE
 #if defined(BOOST_PROCESS_DOXYGEN)
 namespace boost { namespace process { namespace initializers {
 
+/**
+ * Reports asynchronously whether a child process could be started.
+ *
+ * Unlike \c set_on_error this initializer doesn't block the parent
+ * process until the child process has called \c execve. The handler
+ * is called by the I/O service with an error code and the step which
+ * failed (\c boost::process::posix::exec_stage). If the program was
+ * started, the error code is empty and the step is \c exec_stage_none.
+ * If the program is started with \c posix_spawn, every failure is
+ * reported as \c exec_stage_spawn.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class async_on_error : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \c handler_type must be a function or functor with this
+     * signature: <tt>void(const boost::system::error_code&,
+     * boost::process::posix::exec_stage)</tt>
+     */
+    async_on_error(boost::asio::io_service &io_service,
+        handler_type handler);
+};
+
 /**
  * Binds the standard error stream.
  */
@@ -48,6 +75,59 @@ public:
     explicit bind_stdin(const boost::iostreams::file_descriptor_source &source);
 };
 
+/**
+ * Binds the standard input stream to a copy of data in memory.
+ *
+ * The data is copied into an anonymous file created with \c memfd_create
+ * which is sealed, so the child process can neither modify nor resize it.
+ * Unlike a pipe the file can be mapped into memory and seeked, and the
+ * parent process doesn't need to write to it after the child process
+ * has been started. Without \c memfd_create an unlinked file in the
+ * temporary directory is used.
+ *
+ * The file offset is reset before every start. Child processes started
+ * with the same initializer share the offset.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class bind_stdin_from_memory : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     *
+     * Copies the buffer into the file.
+     */
+    explicit bind_stdin_from_memory(const boost::asio::const_buffer &buffer);
+
+    /**
+     * Constructor.
+     *
+     * Copies the buffer into the file.
+     */
+    bind_stdin_from_memory(const boost::asio::const_buffer &buffer,
+        boost::system::error_code &ec);
+
+    /**
+     * Constructor.
+     *
+     * Copies everything from \c source into the file. On Linux the data
+     * is copied with \c copy_file_range if possible.
+     */
+    explicit bind_stdin_from_memory(
+        const boost::iostreams::file_descriptor_source &source);
+
+    /**
+     * Constructor.
+     *
+     * Copies everything from \c source into the file. On Linux the data
+     * is copied with \c copy_file_range if possible.
+     */
+    bind_stdin_from_memory(
+        const boost::iostreams::file_descriptor_source &source,
+        boost::system::error_code &ec);
+};
+
 /**
  * Binds the standard output stream.
  */
@@ -60,6 +140,52 @@ public:
     explicit bind_stdout(const boost::iostreams::file_descriptor_sink &sink);
 };
 
+/**
+ * Captures the standard output stream in memory.
+ *
+ * The child process writes to an anonymous file created with
+ * \c memfd_create instead of a pipe, so it never blocks because the
+ * parent process doesn't read fast enough. After the child process has
+ * exited \c buffer returns the output mapped read-only into memory.
+ * Without \c memfd_create an unlinked file in the temporary directory
+ * is used.
+ *
+ * Child processes started with the same initializer append to the same
+ * file. The file is kept until the last copy of the initializer is
+ * destroyed.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class capture_stdout_to_memory : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     */
+    capture_stdout_to_memory();
+
+    /**
+     * Constructor.
+     */
+    explicit capture_stdout_to_memory(boost::system::error_code &ec);
+
+    /**
+     * Returns the output written so far.
+     *
+     * The buffer is valid until the initializer is destroyed or until
+     * \c buffer is called again after more output has been written.
+     */
+    boost::asio::const_buffer buffer() const;
+
+    /**
+     * Returns the output written so far.
+     *
+     * The buffer is valid until the initializer is destroyed or until
+     * \c buffer is called again after more output has been written.
+     */
+    boost::asio::const_buffer buffer(boost::system::error_code &ec) const;
+};
+
 /**
  * Binds a file descriptor.
  *
@@ -112,6 +238,9 @@ public:
  * flag. File descriptors are closed when \c execve
  * is called and the call succeeds.
  *
+ * On Linux only file descriptors which are actually open are passed
+ * to the predicate.
+ *
  * \remark <em>POSIX only.</em>
  */
 class close_fds_if : public initializer_base
@@ -126,6 +255,26 @@ public:
     explicit close_fds_if(const predicate_type &pred);
 };
 
+/**
+ * Closes all file descriptors except the ones passed.
+ *
+ * Like \c close_fds_if this initializer sets the \c FD_CLOEXEC
+ * flag. It uses \c close_range if the kernel supports it. Otherwise
+ * only file descriptors which are actually open are visited.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class close_all_fds_except : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     *
+     * \c range_type must be an <tt>int</tt>-range.
+     */
+    explicit close_all_fds_except(const range_type &fds);
+};
+
 /**
  * Closes the standard error stream.
  */
@@ -171,6 +320,62 @@ public:
     hide_console();
 };
 
+/**
+ * Starts the child process in a new process group.
+ *
+ * The process group ID is the process ID of the child. Use
+ * \c boost::process::posix::terminate_group to signal all processes
+ * in the group.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class new_process_group : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     */
+    new_process_group();
+};
+
+/**
+ * Starts the child process in a new session.
+ *
+ * The child process becomes the leader of a new session and of a new
+ * process group. It has no controlling terminal.
+ *
+ * \remark <em>POSIX only.</em>
+ */
+class new_session : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     */
+    new_session();
+};
+
+/**
+ * Starts the child process with a fork server.
+ *
+ * The fork server receives the executable, the command line, the
+ * environment, the work directory and the file descriptors to bind
+ * over a Unix domain socket and starts the program. The program is
+ * a child of the calling process. Initializers which run code in
+ * the child process like \c on_exec_setup can't be used together
+ * with \c via.
+ *
+ * \remark <em>Linux only.</em>
+ */
+class via : public initializer_base
+{
+public:
+    /**
+     * Constructor.
+     */
+    explicit via(boost::process::posix::fork_server &server);
+};
+
 /**
  * Inherits environment variables.
  */
@@ -387,7 +592,9 @@ public:
      * If Unicode is used, \c range_type must be a
      * <tt>std::wstring</tt>-range.
      *
-     * On POSIX \c range_type must be a <tt>std::string</tt>-range.
+     * On POSIX \c range_type must be a <tt>std::string</tt>-range
+     * or a \c boost::process::posix::argv_builder. The argument
+     * vector of an \c argv_builder is used without being copied.
      */
     explicit set_args(const range_type &r);
 };
@@ -429,7 +636,8 @@ public:
      * If Unicode is used, \c range_type must be a
      * <tt>std::wstring</tt>-range.
      *
-     * On POSIX \c range_type must be a <tt>std::string</tt>-range.
+     * On POSIX \c range_type must be a <tt>std::string</tt>-range
+     * or a \c boost::process::posix::environment.
      */
     explicit set_env(const range_type &r);
 };
@@ -444,6 +652,19 @@ public:
      * Constructor.
      */
     explicit set_on_error(boost::system::error_code &ec);
+
+    /**
+     * Constructor.
+     *
+     * Sets \c stage to the step which failed in the child process,
+     * for example \c exec_stage_chdir or \c exec_stage_execve. If the
+     * program is started with \c posix_spawn, every failure is reported
+     * as \c exec_stage_spawn.
+     *
+     * \remark <em>POSIX only.</em>
+     */
+    set_on_error(boost::system::error_code &ec,
+        boost::process::posix::exec_stage &stage);
 };
 
 /**
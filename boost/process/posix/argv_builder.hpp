@@ -0,0 +1,211 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_ARGV_BUILDER_HPP
+#define BOOST_PROCESS_POSIX_ARGV_BUILDER_HPP
+
+#include <boost/utility/string_ref.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/mpl/and.hpp>
+#include <boost/mpl/not.hpp>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstddef>
+#include <new>
+
+namespace boost { namespace process { namespace posix {
+
+// Builds an argument vector in a single buffer.
+//
+// The pointer array grows from the front of the buffer, the argument
+// bytes grow from the back. Both are moved to a larger buffer at once
+// if the buffer is full. A builder which is cleared and reused doesn't
+// allocate once its buffer is large enough. The buffer can be supplied
+// by the caller. It is only used until it is full.
+//
+// argv() is valid until the builder is modified or destroyed.
+class argv_builder
+{
+public:
+    argv_builder() : buf_(0), size_(0), owned_(false), argc_(0), used_(0)
+    {
+        reserve(sizeof(char*) * 8 + 256);
+    }
+
+    argv_builder(char *buffer, std::size_t size)
+        : buf_(0), size_(0), owned_(false), argc_(0), used_(0)
+    {
+        std::size_t skip = (sizeof(char*) -
+            reinterpret_cast<std::size_t>(buffer) % sizeof(char*)) %
+            sizeof(char*);
+        if (size >= skip + sizeof(char*))
+        {
+            buf_ = buffer + skip;
+            size_ = size - skip;
+            argv_ptr()[0] = 0;
+        }
+        else
+        {
+            reserve(sizeof(char*) * 8 + 256);
+        }
+    }
+
+    argv_builder(const argv_builder &other)
+        : buf_(0), size_(0), owned_(false), argc_(0), used_(0)
+    {
+        reserve(other.size_);
+        assign(other);
+    }
+
+    argv_builder &operator=(const argv_builder &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            if (size_ < other.bytes_needed(0))
+                reserve(other.size_);
+            assign(other);
+        }
+        return *this;
+    }
+
+    ~argv_builder()
+    {
+        if (owned_)
+            ::operator delete(buf_);
+    }
+
+    argv_builder &arg(const char *s, std::size_t n)
+    {
+        if (bytes_needed(n + 1) > size_)
+        {
+            // s may point to an argument in the buffer, e.g. (*this)[0],
+            // which reserve() moves and frees.
+            std::less<const char*> less;
+            bool inside = buf_ && !less(s, buf_) && less(s, buf_ + size_);
+            std::size_t offset = inside ? buf_ + size_ - s : 0;
+            reserve((std::max)(size_ * 2, bytes_needed(n + 1)));
+            if (inside)
+                s = buf_ + size_ - offset;
+        }
+        used_ += n + 1;
+        char *p = buf_ + size_ - used_;
+        std::memcpy(p, s, n);
+        p[n] = 0;
+        char **argv = argv_ptr();
+        argv[argc_++] = p;
+        argv[argc_] = 0;
+        return *this;
+    }
+
+    argv_builder &arg(const char *s)
+    {
+        return arg(s, std::strlen(s));
+    }
+
+    argv_builder &arg(const std::string &s)
+    {
+        return arg(s.data(), s.size());
+    }
+
+    argv_builder &arg(boost::string_ref s)
+    {
+        return arg(s.data(), s.size());
+    }
+
+    template <class Integer>
+    typename boost::enable_if<boost::mpl::and_<boost::is_integral<Integer>,
+        boost::mpl::not_<boost::is_same<Integer, char> >,
+        boost::mpl::not_<boost::is_same<Integer, bool> > >,
+        argv_builder&>::type arg(Integer i)
+    {
+        char digits[3 * sizeof(Integer) + 2];
+        char *end = digits + sizeof(digits);
+        char *p = end;
+        bool negative = boost::is_signed<Integer>::value && i < Integer(0);
+        do
+        {
+            int d = static_cast<int>(i % 10);
+            *--p = static_cast<char>('0' + (d < 0 ? -d : d));
+            i /= 10;
+        } while (i != 0);
+        if (negative)
+            *--p = '-';
+        return arg(p, end - p);
+    }
+
+    void clear()
+    {
+        argc_ = 0;
+        used_ = 0;
+        if (buf_)
+            argv_ptr()[0] = 0;
+    }
+
+    std::size_t size() const { return argc_; }
+
+    bool empty() const { return argc_ == 0; }
+
+    const char *operator[](std::size_t i) const { return argv_ptr()[i]; }
+
+    char **argv() const { return argv_ptr(); }
+
+private:
+    char **argv_ptr() const
+    {
+        return reinterpret_cast<char**>(buf_);
+    }
+
+    std::size_t bytes_needed(std::size_t n) const
+    {
+        return sizeof(char*) * (argc_ + (n ? 2 : 1)) + used_ + n;
+    }
+
+    void reserve(std::size_t size)
+    {
+        size = (size + sizeof(char*) - 1) / sizeof(char*) * sizeof(char*);
+        char *buf = static_cast<char*>(::operator new(size));
+        char **argv = reinterpret_cast<char**>(buf);
+        if (buf_)
+        {
+            std::memcpy(buf + size - used_, buf_ + size_ - used_, used_);
+            char **old = argv_ptr();
+            for (std::size_t i = 0; i < argc_; ++i)
+                argv[i] = buf + size - (buf_ + size_ - old[i]);
+        }
+        argv[argc_] = 0;
+        if (owned_)
+            ::operator delete(buf_);
+        buf_ = buf;
+        size_ = size;
+        owned_ = true;
+    }
+
+    void assign(const argv_builder &other)
+    {
+        char **argv = other.argv_ptr();
+        for (std::size_t i = 0; i < other.argc_; ++i)
+            arg(argv[i]);
+    }
+
+    char *buf_;
+    std::size_t size_;
+    bool owned_;
+    std::size_t argc_;
+    std::size_t used_;
+};
+
+}}}
+
+#endif
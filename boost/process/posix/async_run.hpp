@@ -0,0 +1,206 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_ASYNC_RUN_HPP
+#define BOOST_PROCESS_POSIX_ASYNC_RUN_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/async_wait_for_exit.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/executor.hpp>
+#include <boost/process/posix/exit_info.hpp>
+#include <boost/process/posix/initializers/capture_stdout_to_memory.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/fusion/algorithm/transformation/push_back.hpp>
+#include <boost/fusion/mpl.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/ref.hpp>
+#include <unistd.h>
+#include <spawn.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+enum run_flags
+{
+    run_default = 0,
+    capture_stdout = 1,
+    capture_stderr = 2
+};
+
+struct run_result
+{
+    exit_info info;
+    boost::asio::const_buffer out;
+    boost::asio::const_buffer err;
+
+    // Keep the mappings out and err point to.
+    boost::shared_ptr<detail::memory_capture> out_memory;
+    boost::shared_ptr<detail::memory_capture> err_memory;
+};
+
+namespace detail {
+
+// Binds the memfds which capture stdout and stderr. Streams which aren't
+// captured are inherited.
+class run_captures : public initializers::initializer_base
+{
+public:
+    explicit run_captures(run_result &r) : r_(r) {}
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if ((r_.out_memory &&
+            dup_fd(r_.out_memory->fd(), STDOUT_FILENO) == -1) ||
+            (r_.err_memory &&
+            dup_fd(r_.err_memory->fd(), STDERR_FILENO) == -1))
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        if (r_.out_memory)
+            ::posix_spawn_file_actions_adddup2(e.file_actions,
+                r_.out_memory->fd(), STDOUT_FILENO);
+        if (r_.err_memory)
+            ::posix_spawn_file_actions_adddup2(e.file_actions,
+                r_.err_memory->fd(), STDERR_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        if (r_.out_memory)
+            e.request->bind(r_.out_memory->fd(), STDOUT_FILENO);
+        if (r_.err_memory)
+            e.request->bind(r_.err_memory->fd(), STDERR_FILENO);
+    }
+
+private:
+    run_result &r_;
+};
+
+inline bool create_capture(bool wanted,
+    boost::shared_ptr<memory_capture> &capture)
+{
+    if (!wanted)
+        return true;
+    capture.reset(new memory_capture());
+    return capture->fd() != -1;
+}
+
+inline bool map_capture(const boost::shared_ptr<memory_capture> &capture,
+    boost::asio::const_buffer &buffer)
+{
+    if (!capture)
+        return true;
+    if (!capture->map())
+        return false;
+    buffer = capture->buffer();
+    return true;
+}
+
+template <class Handler>
+struct run_handler
+{
+    run_result r_;
+    Handler handler_;
+
+    run_handler(const run_result &r, Handler handler)
+        : r_(r), handler_(handler) {}
+
+    void operator()(const boost::system::error_code &ec, const exit_info &info)
+    {
+        boost::system::error_code run_ec = ec;
+        r_.info = info;
+        if (!run_ec && (!map_capture(r_.out_memory, r_.out) ||
+            !map_capture(r_.err_memory, r_.err)))
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(run_ec);
+        handler_(run_ec, r_);
+    }
+};
+
+}
+
+namespace initializers {
+
+template <>
+struct is_spawnable<posix::detail::run_captures> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<posix::detail::run_captures> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<posix::detail::run_captures> :
+    boost::true_type {};
+
+}
+
+template <class InitializerSequence, class Handler>
+void async_run(boost::asio::io_service &io_service,
+    const InitializerSequence &initializers, int flags, Handler handler)
+{
+    // The captures are bound after the initializers and would silently
+    // replace the streams the initializers bind.
+    bool binds_stdout = any_initializer<InitializerSequence,
+        initializers::binds_stdout>::value;
+    bool binds_stderr = any_initializer<InitializerSequence,
+        initializers::binds_stderr>::value;
+    if (((flags & capture_stdout) && binds_stdout) ||
+        ((flags & capture_stderr) && binds_stderr))
+    {
+        boost::system::error_code ec(EINVAL,
+            boost::system::system_category());
+        io_service.post(boost::bind<void>(handler, ec, run_result()));
+        return;
+    }
+
+    run_result r;
+    if (!detail::create_capture((flags & capture_stdout) != 0,
+        r.out_memory) || !detail::create_capture(
+        (flags & capture_stderr) != 0, r.err_memory))
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        io_service.post(boost::bind<void>(handler, ec, r));
+        return;
+    }
+
+    detail::run_captures captures(r);
+    executor e;
+    child c = e(boost::fusion::push_back(initializers, boost::cref(captures)));
+    if (c.pid == -1)
+    {
+        boost::system::error_code ec(e.failed_errno,
+            boost::system::system_category());
+        io_service.post(boost::bind<void>(handler, ec, r));
+        return;
+    }
+
+    async_wait_for_exit_info(io_service, c,
+        detail::run_handler<Handler>(r, handler));
+}
+
+template <class InitializerSequence, class Handler>
+void async_run(boost::asio::io_service &io_service,
+    const InitializerSequence &initializers, Handler handler)
+{
+    async_run(io_service, initializers, run_default, handler);
+}
+
+}}}
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_ASYNC_WAIT_FOR_EXIT_HPP
+#define BOOST_PROCESS_POSIX_ASYNC_WAIT_FOR_EXIT_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/exit_info.hpp>
+#include <boost/process/posix/sigchld_service.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+template <class Handler>
+struct wait_for_exit_op
+{
+    boost::asio::posix::stream_descriptor descriptor;
+    pid_t pid;
+    Handler handler;
+
+    wait_for_exit_op(boost::asio::io_service &io_service, int fd, pid_t p,
+        Handler h) : descriptor(io_service, fd), pid(p), handler(h) {}
+};
+
+template <class Handler>
+struct wait_for_exit_handler
+{
+    boost::shared_ptr<wait_for_exit_op<Handler> > op_;
+
+    explicit wait_for_exit_handler(
+        const boost::shared_ptr<wait_for_exit_op<Handler> > &op) : op_(op) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t)
+    {
+        if (ec)
+        {
+            op_->handler(ec, exit_info());
+            return;
+        }
+        pid_t ret;
+        int status;
+        struct rusage usage;
+        do
+        {
+            ret = ::wait4(op_->pid, &status, 0, &usage);
+        } while (ret == -1 && errno == EINTR);
+        boost::system::error_code wait_ec;
+        if (ret == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(wait_ec);
+            op_->handler(wait_ec, exit_info());
+        }
+        else
+        {
+            op_->handler(wait_ec, exit_info(status, usage));
+        }
+    }
+};
+
+}
+
+template <class Process, class Handler>
+void async_wait_for_exit_info(boost::asio::io_service &io_service,
+    const Process &p, Handler handler)
+{
+    if (p.pidfd == -1)
+    {
+        boost::asio::use_service<sigchld_service>(io_service).async_wait_info(
+            p.pid, handler);
+        return;
+    }
+
+    int fd = ::fcntl(p.pidfd, F_DUPFD_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        io_service.post(boost::bind<void>(handler, ec, exit_info()));
+        return;
+    }
+
+    boost::shared_ptr<detail::wait_for_exit_op<Handler> > op(
+        new detail::wait_for_exit_op<Handler>(io_service, fd, p.pid, handler));
+    op->descriptor.async_read_some(boost::asio::null_buffers(),
+        detail::wait_for_exit_handler<Handler>(op));
+}
+
+template <class Process, class Handler>
+void async_wait_for_exit(boost::asio::io_service &io_service,
+    const Process &p, Handler handler)
+{
+    async_wait_for_exit_info(io_service, p,
+        detail::status_handler<Handler>(handler));
+}
+
+}}}
+
+#endif
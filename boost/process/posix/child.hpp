@@ -10,17 +10,62 @@
 #ifndef BOOST_PROCESS_POSIX_CHILD_HPP
 #define BOOST_PROCESS_POSIX_CHILD_HPP
 
+#include <boost/move/move.hpp>
 #include <sys/types.h>
+#include <unistd.h>
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_pidfd_open)
+#   define BOOST_PROCESS_POSIX_HAS_PIDFD
+#endif
 
 namespace boost { namespace process { namespace posix {
 
-struct child
+class child
 {
+public:
     pid_t pid;
+    int pidfd;
+
+    explicit child(pid_t p, int fd = -1) : pid(p), pidfd(fd) {}
+
+    ~child()
+    {
+        if (pidfd != -1)
+            ::close(pidfd);
+    }
 
-    explicit child(pid_t p) : pid(p) {}
+    child(BOOST_RV_REF(child) c) : pid(c.pid), pidfd(c.pidfd)
+    {
+        c.pidfd = -1;
+    }
+
+    child &operator=(BOOST_RV_REF(child) c)
+    {
+        if (pidfd != -1)
+            ::close(pidfd);
+        pid = c.pid;
+        pidfd = c.pidfd;
+        c.pidfd = -1;
+        return *this;
+    }
+
+private:
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(child);
 };
 
+inline child make_child(pid_t pid)
+{
+    int fd = -1;
+#if defined(BOOST_PROCESS_POSIX_HAS_PIDFD)
+    if (pid != -1)
+        fd = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#endif
+    return child(pid, fd);
+}
+
 }}}
 
 #endif
@@ -0,0 +1,447 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_COMMUNICATE_HPP
+#define BOOST_PROCESS_POSIX_COMMUNICATE_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/async_wait_for_exit.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/feed_stdin.hpp>
+#include <boost/process/posix/wait_for_exit.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+// Writing to a pipe whose read-end is closed raises SIGPIPE. The signal
+// is blocked in the calling thread while the guard exists, and if it was
+// raised, it is consumed before it is unblocked again. Then the write
+// fails with EPIPE which means the child process doesn't read its input.
+class sigpipe_guard : boost::noncopyable
+{
+public:
+    sigpipe_guard()
+    {
+        sigemptyset(&set_);
+        sigaddset(&set_, SIGPIPE);
+        sigset_t pending;
+        sigemptyset(&pending);
+        ::sigpending(&pending);
+        was_pending_ = sigismember(&pending, SIGPIPE) == 1;
+        ::pthread_sigmask(SIG_BLOCK, &set_, &old_);
+    }
+
+    ~sigpipe_guard()
+    {
+        int e = errno;
+        sigset_t pending;
+        sigemptyset(&pending);
+        ::sigpending(&pending);
+        if (!was_pending_ && sigismember(&pending, SIGPIPE) == 1)
+        {
+            int sig;
+            ::sigwait(&set_, &sig);
+        }
+        ::pthread_sigmask(SIG_SETMASK, &old_, 0);
+        errno = e;
+    }
+
+private:
+    sigset_t set_;
+    sigset_t old_;
+    bool was_pending_;
+};
+
+// Reads directly into a string. The string grows geometrically, so every
+// byte is copied a constant number of times on average. shrink() removes
+// the bytes which haven't been read yet. It is also called when the object
+// is destroyed.
+class output_buffer : boost::noncopyable
+{
+public:
+    explicit output_buffer(std::string &s) : s_(s), filled_(s.size()) {}
+
+    ~output_buffer()
+    {
+        shrink();
+    }
+
+    void shrink()
+    {
+        s_.resize(filled_);
+    }
+
+    // Returns the number of bytes read, 0 at end of file and -1 on error.
+    ssize_t read_some(int fd)
+    {
+        if (filled_ == s_.size())
+            s_.resize((std::max)(2 * s_.size(), std::size_t(64 * 1024)));
+        ssize_t n;
+        do
+        {
+            n = ::read(fd, &s_[filled_], s_.size() - filled_);
+        } while (n == -1 && errno == EINTR);
+        if (n > 0)
+            filled_ += n;
+        return n;
+    }
+
+private:
+    std::string &s_;
+    std::size_t filled_;
+};
+
+inline void close_if_open(int &fd)
+{
+    if (fd != -1)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+inline bool set_nonblocking(int fd)
+{
+    if (fd == -1)
+        return true;
+    int flags = ::fcntl(fd, F_GETFL);
+    return flags != -1 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// Writes input to in and reads from out and err until the child process
+// closes them. The data is copied with writev(2) as the caller may reuse
+// input as soon as the function returns. All file descriptors are closed.
+inline bool communicate_io(int in, const boost::asio::const_buffer &input,
+    int out, std::string &output, int err, std::string &error)
+{
+    sigpipe_guard guard;
+    feed_state state(boost::asio::const_buffers_1(input), feed_default);
+    output_buffer out_buffer(output);
+    output_buffer err_buffer(error);
+    bool ok = set_nonblocking(in) && set_nonblocking(out) &&
+        set_nonblocking(err);
+    if (ok && state.done())
+        close_if_open(in);
+
+    while (ok && (in != -1 || out != -1 || err != -1))
+    {
+        struct pollfd fds[3];
+        fds[0].fd = in;
+        fds[0].events = POLLOUT;
+        fds[1].fd = out;
+        fds[1].events = POLLIN;
+        fds[2].fd = err;
+        fds[2].events = POLLIN;
+        for (int i = 0; i < 3; ++i)
+            fds[i].revents = 0;
+        if (::poll(fds, 3, -1) == -1)
+        {
+            ok = errno == EINTR;
+            continue;
+        }
+
+        if (fds[0].revents)
+        {
+            ssize_t n = 0;
+            while (!state.done() && (n = state.feed_some(in, true)) > 0)
+                ;
+            if (state.done() || (n == -1 && errno == EPIPE))
+                close_if_open(in);
+            else if (n == -1 && errno != EAGAIN)
+                ok = false;
+        }
+
+        for (int i = 1; ok && i < 3; ++i)
+        {
+            if (!fds[i].revents)
+                continue;
+            int &fd = i == 1 ? out : err;
+            output_buffer &buffer = i == 1 ? out_buffer : err_buffer;
+            ssize_t n;
+            while ((n = buffer.read_some(fd)) > 0)
+                ;
+            if (n == 0)
+                close_if_open(fd);
+            else if (errno != EAGAIN)
+                ok = false;
+        }
+    }
+
+    int e = errno;
+    close_if_open(in);
+    close_if_open(out);
+    close_if_open(err);
+    errno = e;
+    return ok;
+}
+
+// Passes the first I/O error instead of the result of waiting for the
+// child process, which is always reaped.
+template <class Handler>
+struct communicate_exit_handler
+{
+    Handler handler_;
+    boost::system::error_code ec_;
+
+    communicate_exit_handler(Handler h, const boost::system::error_code &ec)
+        : handler_(h), ec_(ec) {}
+
+    void operator()(const boost::system::error_code &ec, int status)
+    {
+        handler_(ec_ ? ec_ : ec, status);
+    }
+};
+
+template <class Handler>
+struct communicate_op
+{
+    boost::asio::io_service &io_service;
+    child c;
+    boost::asio::posix::stream_descriptor in;
+    boost::asio::posix::stream_descriptor out;
+    boost::asio::posix::stream_descriptor err;
+    feed_state state;
+    output_buffer out_buffer;
+    output_buffer err_buffer;
+    Handler handler;
+    int pending;
+    boost::system::error_code ec;
+
+    communicate_op(boost::asio::io_service &ios, pid_t pid, int pidfd,
+        int in_fd, const boost::asio::const_buffer &input, int out_fd,
+        std::string &output, int err_fd, std::string &error, Handler h)
+        : io_service(ios), c(pid, pidfd), in(ios), out(ios), err(ios),
+          state(boost::asio::const_buffers_1(input), feed_default),
+          out_buffer(output), err_buffer(error), handler(h), pending(0)
+    {
+        if (in_fd != -1)
+            in.assign(in_fd);
+        if (out_fd != -1)
+            out.assign(out_fd);
+        if (err_fd != -1)
+            err.assign(err_fd);
+    }
+
+    // Called once for every pipe when it has been closed or an error
+    // occured. The first error closes all pipes. The child process is
+    // waited for once all pipes are closed, even after an error.
+    void finish(const boost::system::error_code &e);
+};
+
+template <class Handler>
+void communicate_op<Handler>::finish(const boost::system::error_code &e)
+{
+    if (e && !ec)
+    {
+        ec = e;
+        boost::system::error_code ignored;
+        in.close(ignored);
+        out.close(ignored);
+        err.close(ignored);
+    }
+    if (--pending > 0)
+        return;
+    out_buffer.shrink();
+    err_buffer.shrink();
+    async_wait_for_exit(io_service, c,
+        communicate_exit_handler<Handler>(handler, ec));
+}
+
+template <class Handler>
+struct communicate_write_handler
+{
+    boost::shared_ptr<communicate_op<Handler> > op_;
+
+    explicit communicate_write_handler(
+        const boost::shared_ptr<communicate_op<Handler> > &op) : op_(op) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t)
+    {
+        if (ec)
+        {
+            op_->finish(ec);
+            return;
+        }
+
+        sigpipe_guard guard;
+        ssize_t n = 0;
+        while (!op_->state.done() &&
+            (n = op_->state.feed_some(op_->in.native_handle(), true)) > 0)
+            ;
+
+        boost::system::error_code write_ec;
+        if (n == -1 && errno != EAGAIN && errno != EPIPE)
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(write_ec);
+        if (op_->state.done() || (n == -1 && errno != EAGAIN))
+        {
+            boost::system::error_code ignored;
+            op_->in.close(ignored);
+            op_->finish(write_ec);
+        }
+        else
+        {
+            op_->in.async_write_some(boost::asio::null_buffers(), *this);
+        }
+    }
+};
+
+template <class Handler>
+struct communicate_read_handler
+{
+    boost::shared_ptr<communicate_op<Handler> > op_;
+    bool stderr_;
+
+    communicate_read_handler(
+        const boost::shared_ptr<communicate_op<Handler> > &op, bool e)
+        : op_(op), stderr_(e) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t)
+    {
+        if (ec)
+        {
+            op_->finish(ec);
+            return;
+        }
+
+        boost::asio::posix::stream_descriptor &d =
+            stderr_ ? op_->err : op_->out;
+        output_buffer &buffer = stderr_ ? op_->err_buffer : op_->out_buffer;
+        ssize_t n;
+        while ((n = buffer.read_some(d.native_handle())) > 0)
+            ;
+
+        if (n == 0)
+        {
+            boost::system::error_code ignored;
+            d.close(ignored);
+            op_->finish(boost::system::error_code());
+        }
+        else if (errno != EAGAIN)
+        {
+            boost::system::error_code read_ec;
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(read_ec);
+            op_->finish(read_ec);
+        }
+        else
+        {
+            d.async_read_some(boost::asio::null_buffers(), *this);
+        }
+    }
+};
+
+}
+
+template <class Process>
+inline int communicate(const Process &p, int in,
+    const boost::asio::const_buffer &input, int out, std::string &output,
+    int err, std::string &error)
+{
+    if (!detail::communicate_io(in, input, out, output, err, error))
+    {
+        int e = errno;
+        boost::system::error_code ignored;
+        wait_for_exit(p, ignored);
+        errno = e;
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("communicate() failed");
+    }
+    return wait_for_exit(p);
+}
+
+template <class Process>
+inline int communicate(const Process &p, int in,
+    const boost::asio::const_buffer &input, int out, std::string &output,
+    int err, std::string &error, boost::system::error_code &ec)
+{
+    if (!detail::communicate_io(in, input, out, output, err, error))
+    {
+        boost::system::error_code io_ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(io_ec);
+        int status = wait_for_exit(p, ec);
+        ec = io_ec;
+        return status;
+    }
+    return wait_for_exit(p, ec);
+}
+
+template <class Process, class Handler>
+void async_communicate(boost::asio::io_service &io_service, const Process &p,
+    int in, const boost::asio::const_buffer &input, int out,
+    std::string &output, int err, std::string &error, Handler handler)
+{
+    int pidfd = -1;
+    if (p.pidfd != -1 && (pidfd = ::fcntl(p.pidfd, F_DUPFD_CLOEXEC, 0)) == -1)
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        detail::close_if_open(in);
+        detail::close_if_open(out);
+        detail::close_if_open(err);
+        async_wait_for_exit(io_service, child(p.pid, -1),
+            detail::communicate_exit_handler<Handler>(handler, ec));
+        return;
+    }
+
+    boost::shared_ptr<detail::communicate_op<Handler> > op(
+        new detail::communicate_op<Handler>(io_service, p.pid, pidfd, in,
+            input, out, output, err, error, handler));
+    // One reference is held until all pipes are closed, so finish() isn't
+    // called before every pipe has been registered.
+    ++op->pending;
+
+    boost::system::error_code ec;
+    if (op->in.is_open() && !op->state.done())
+    {
+        ++op->pending;
+        op->in.non_blocking(true, ec);
+        op->in.async_write_some(boost::asio::null_buffers(),
+            detail::communicate_write_handler<Handler>(op));
+    }
+    else
+    {
+        op->in.close(ec);
+    }
+    if (op->out.is_open())
+    {
+        ++op->pending;
+        op->out.non_blocking(true, ec);
+        op->out.async_read_some(boost::asio::null_buffers(),
+            detail::communicate_read_handler<Handler>(op, false));
+    }
+    if (op->err.is_open())
+    {
+        ++op->pending;
+        op->err.non_blocking(true, ec);
+        op->err.async_read_some(boost::asio::null_buffers(),
+            detail::communicate_read_handler<Handler>(op, true));
+    }
+    op->finish(boost::system::error_code());
+}
+
+}}}
+
+#endif
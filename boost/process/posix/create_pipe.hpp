@@ -12,11 +12,63 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/posix/pipe.hpp>
+#include <boost/process/posix/pipe_capacity.hpp>
 #include <boost/system/error_code.hpp>
+#include <cstddef>
 #include <unistd.h>
+#include <fcntl.h>
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+    defined(__OpenBSD__) || defined(__DragonFly__)
+#   define BOOST_PROCESS_POSIX_HAS_PIPE2
+#endif
 
 namespace boost { namespace process { namespace posix {
 
+namespace detail {
+
+inline int create_pipe(int fds[2], int flags)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_PIPE2)
+    return ::pipe2(fds, flags);
+#else
+    // Not atomic: another thread may fork before FD_CLOEXEC is set.
+    if (::pipe(fds) == -1)
+        return -1;
+    for (int i = 0; i < 2; ++i)
+    {
+        if ((flags & O_CLOEXEC &&
+                ::fcntl(fds[i], F_SETFD, FD_CLOEXEC) == -1) ||
+            (flags & O_NONBLOCK &&
+                ::fcntl(fds[i], F_SETFL, O_NONBLOCK) == -1))
+        {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return -1;
+        }
+    }
+    return 0;
+#endif
+}
+
+// Returns the capacity which has been set or -1 on error.
+inline int create_pipe(int fds[2], int flags, std::size_t capacity)
+{
+    if (create_pipe(fds, flags) == -1)
+        return -1;
+    int actual = set_pipe_capacity(fds[0], capacity);
+    if (actual == -1)
+    {
+        int e = errno;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        errno = e;
+    }
+    return actual;
+}
+
+}
+
 inline pipe create_pipe()
 {
     int fds[2];
@@ -35,6 +87,71 @@ inline pipe create_pipe(boost::system::error_code &ec)
     return pipe(fds[0], fds[1]);
 }
 
+inline pipe create_pipe(int flags)
+{
+    int fds[2];
+    if (detail::create_pipe(fds, flags) == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("pipe2(2) failed");
+    return pipe(fds[0], fds[1]);
+}
+
+inline pipe create_pipe(int flags, boost::system::error_code &ec)
+{
+    int fds[2] = { -1, -1 };
+    if (detail::create_pipe(fds, flags) == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+    return pipe(fds[0], fds[1]);
+}
+
+inline pipe create_pipe(int flags, std::size_t capacity)
+{
+    int fds[2];
+    if (detail::create_pipe(fds, flags, capacity) == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("create_pipe() failed");
+    return pipe(fds[0], fds[1]);
+}
+
+inline pipe create_pipe(int flags, std::size_t capacity,
+    boost::system::error_code &ec)
+{
+    int fds[2] = { -1, -1 };
+    if (detail::create_pipe(fds, flags, capacity) == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+    return pipe(fds[0], fds[1]);
+}
+
+inline pipe create_pipe(int flags, std::size_t capacity, std::size_t &actual)
+{
+    int fds[2];
+    int ret = detail::create_pipe(fds, flags, capacity);
+    if (ret == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("create_pipe() failed");
+    actual = ret;
+    return pipe(fds[0], fds[1]);
+}
+
+inline pipe create_pipe(int flags, std::size_t capacity, std::size_t &actual,
+    boost::system::error_code &ec)
+{
+    int fds[2] = { -1, -1 };
+    int ret = detail::create_pipe(fds, flags, capacity);
+    if (ret == -1)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        actual = 0;
+    }
+    else
+    {
+        ec.clear();
+        actual = ret;
+    }
+    return pipe(fds[0], fds[1]);
+}
+
 }}}
 
 #endif
@@ -0,0 +1,39 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_CLOSE_FD_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_CLOSE_FD_HPP
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+// Closes fd in the child process. A file descriptor which isn't open is
+// what the caller wants. On Linux fd is closed even if close() fails with
+// EINTR.
+inline int close_fd(int fd)
+{
+    if (::close(fd) == -1 && errno != EBADF && errno != EINTR)
+        return -1;
+    return 0;
+}
+
+// Marks fd to be closed by execve().
+inline int set_cloexec(int fd)
+{
+    if (::fcntl(fd, F_SETFD, FD_CLOEXEC) == -1 && errno != EBADF)
+        return -1;
+    return 0;
+}
+
+}}}}
+
+#endif
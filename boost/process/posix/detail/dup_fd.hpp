@@ -0,0 +1,33 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_DUP_FD_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_DUP_FD_HPP
+
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+// Makes fd available as target across execve(). dup2() clears FD_CLOEXEC
+// on target only, so pipe ends created with O_CLOEXEC don't leak. If fd
+// and target are equal dup2() does nothing and the flag is cleared here.
+inline int dup_fd(int fd, int target)
+{
+    if (fd != target)
+        return ::dup2(fd, target);
+    int flags = ::fcntl(fd, F_GETFD);
+    if (flags == -1)
+        return -1;
+    return ::fcntl(fd, F_SETFD, flags & ~FD_CLOEXEC);
+}
+
+}}}}
+
+#endif
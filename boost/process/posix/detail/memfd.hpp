@@ -0,0 +1,151 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_MEMFD_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_MEMFD_HPP
+
+#include <boost/process/posix/detail/write_all.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+#   define BOOST_PROCESS_POSIX_HAS_MEMFD
+#endif
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+#   define BOOST_PROCESS_POSIX_HAS_COPY_FILE_RANGE
+#endif
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+#if defined(BOOST_PROCESS_POSIX_HAS_MEMFD)
+// The constants are defined in <linux/memfd.h> and <linux/fcntl.h> which
+// older C libraries don't include.
+const unsigned int memfd_cloexec = 0x0001U;
+const unsigned int memfd_allow_sealing = 0x0002U;
+const int fcntl_add_seals = 1024 + 9;
+const int seal_seal = 0x0001;
+const int seal_shrink = 0x0002;
+const int seal_grow = 0x0004;
+const int seal_write = 0x0008;
+#endif
+
+// Creates an anonymous file in memory which is closed on execve().
+// Without memfd_create(2) (or if the kernel doesn't support it) a file is
+// created in the temporary directory and unlinked immediately. Returns -1
+// on error.
+inline int create_memfd(const char *name)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_MEMFD)
+    int fd = static_cast<int>(::syscall(SYS_memfd_create, name,
+        memfd_cloexec | memfd_allow_sealing));
+    if (fd != -1 || errno != ENOSYS)
+        return fd;
+#endif
+    const char *dir = std::getenv("TMPDIR");
+    std::string path = dir && *dir ? dir : P_tmpdir;
+    path += '/';
+    path += name;
+    path += ".XXXXXX";
+    int tmp = ::mkstemp(&path[0]);
+    if (tmp == -1)
+        return -1;
+    ::unlink(path.c_str());
+    if (::fcntl(tmp, F_SETFD, FD_CLOEXEC) == -1)
+    {
+        int error = errno;
+        ::close(tmp);
+        errno = error;
+        return -1;
+    }
+    return tmp;
+}
+
+// Makes a file created by create_memfd() immutable. Files which aren't
+// memfds can't be sealed and are left as they are.
+inline int seal_memfd(int fd)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_MEMFD)
+    if (::fcntl(fd, fcntl_add_seals,
+        seal_shrink | seal_grow | seal_write | seal_seal) == -1 &&
+        errno != EINVAL)
+        return -1;
+#else
+    (void)fd;
+#endif
+    return 0;
+}
+
+// Opens the file fd refers to again. Unlike dup(2) the new file
+// descriptor has its own file description and thus its own offset.
+// Requires /proc. Returns -1 on error.
+inline int reopen_fd(int fd)
+{
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    int new_fd;
+    do
+    {
+        new_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    } while (new_fd == -1 && errno == EINTR);
+    return new_fd;
+}
+
+// Appends everything from source to sink. copy_file_range(2) copies in the
+// kernel but fails with EXDEV or EINVAL if the files are on different file
+// systems or aren't regular files. Then read(2) and write(2) are used.
+inline bool copy_fd(int source, int sink)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_COPY_FILE_RANGE)
+    for (;;)
+    {
+        ssize_t n = static_cast<ssize_t>(::syscall(SYS_copy_file_range,
+            source, 0, sink, 0, std::size_t(1024 * 1024 * 1024), 0u));
+        if (n == 0)
+            return true;
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EXDEV && errno != EINVAL && errno != ENOSYS &&
+                errno != EOPNOTSUPP)
+                return false;
+            break;
+        }
+    }
+#endif
+    char buffer[64 * 1024];
+    for (;;)
+    {
+        ssize_t n = ::read(source, buffer, sizeof(buffer));
+        if (n == 0)
+            return true;
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (!write_all(sink, buffer, n))
+            return false;
+    }
+}
+
+}}}}
+
+#endif
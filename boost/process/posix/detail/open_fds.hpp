@@ -0,0 +1,155 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_OPEN_FDS_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_OPEN_FDS_HPP
+
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#ifndef BOOST_PROCESS_POSIX_MAX_FD
+#   define BOOST_PROCESS_POSIX_MAX_FD 32
+#endif
+
+#if defined(__linux__) && defined(SYS_close_range)
+#   define BOOST_PROCESS_POSIX_HAS_CLOSE_RANGE
+#   ifndef CLOSE_RANGE_CLOEXEC
+#       define CLOSE_RANGE_CLOEXEC (1U << 2)
+#   endif
+#endif
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+inline int max_fd()
+{
+    int up;
+#if defined(F_MAXFD)
+    do
+    {
+        up = ::fcntl(0, F_MAXFD);
+    } while (up == -1 && errno == EINTR);
+    if (up == -1)
+#endif
+        up = ::sysconf(_SC_OPEN_MAX);
+    if (up == -1)
+        up = BOOST_PROCESS_POSIX_MAX_FD;
+    return up;
+}
+
+// Sets FD_CLOEXEC on all file descriptors in [first, last]. Returns
+// false if the kernel doesn't support close_range(2).
+inline bool cloexec_range(unsigned int first, unsigned int last)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_CLOSE_RANGE)
+    return ::syscall(SYS_close_range, first, last, CLOSE_RANGE_CLOEXEC) == 0;
+#else
+    return false;
+#endif
+}
+
+// Enumerates the file descriptors open in the calling process.
+//
+// for_each() opens /proc/self/fd itself, so in a child process it lists
+// the file descriptors of the child and not those of the parent. It only
+// uses async-signal-safe system calls and doesn't allocate memory, so it
+// can be called between fork() and execve(). If /proc isn't available,
+// for_each() visits all file descriptors up to max_fd() whether they are
+// open or not.
+class open_fds
+{
+public:
+    template <class Function>
+    static void for_each(Function f)
+    {
+        if (!for_each_listed(f))
+        {
+            int up = max_fd();
+            for (int fd = 0; fd < up; ++fd)
+                f(fd);
+        }
+    }
+
+private:
+    template <class Function>
+    static bool for_each_listed(Function &f)
+    {
+#if defined(__linux__) && defined(SYS_getdents64)
+        int dir;
+        do
+        {
+            dir = ::open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        } while (dir == -1 && errno == EINTR);
+        if (dir == -1)
+            return false;
+
+        struct linux_dirent64
+        {
+            unsigned long long d_ino;
+            long long d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[1];
+        };
+
+        union
+        {
+            char buffer[4096];
+            unsigned long long align;
+        } u;
+
+        for (;;)
+        {
+            long n = ::syscall(SYS_getdents64, dir, u.buffer,
+                sizeof(u.buffer));
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                ::close(dir);
+                return n == 0;
+            }
+            for (long off = 0; off < n;)
+            {
+                const linux_dirent64 *d =
+                    reinterpret_cast<const linux_dirent64*>(u.buffer + off);
+                off += d->d_reclen;
+                int fd = to_fd(d->d_name);
+                if (fd != -1 && fd != dir)
+                    f(fd);
+            }
+        }
+#else
+        (void)f;
+        return false;
+#endif
+    }
+
+    static int to_fd(const char *s)
+    {
+        if (!*s)
+            return -1;
+        int fd = 0;
+        for (; *s; ++s)
+        {
+            if (*s < '0' || *s > '9')
+                return -1;
+            fd = fd * 10 + (*s - '0');
+        }
+        return fd;
+    }
+};
+
+}}}}
+
+#endif
@@ -0,0 +1,39 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_WRITE_ALL_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_WRITE_ALL_HPP
+
+#include <cstddef>
+#include <sys/types.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+inline bool write_all(int fd, const char *data, std::size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::write(fd, data, size);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+}}}}
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_ENVIRONMENT_HPP
+#define BOOST_PROCESS_POSIX_ENVIRONMENT_HPP
+
+#include <boost/unordered_map.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+// From <https://svn.boost.org/trac/boost/changeset/67768>
+#if defined(__APPLE__) && defined(__DYNAMIC__)
+extern "C" { extern char ***_NSGetEnviron(void); }
+#   define environ (*_NSGetEnviron())
+#else
+#   include <unistd.h>
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+// Immutable snapshot of an environment block. All strings are stored in
+// one buffer. Shared by all copies of an environment.
+struct environment_snapshot
+{
+    std::vector<char> block;
+    std::vector<char*> envp;
+    boost::unordered_map<std::string, std::size_t> index;
+
+    explicit environment_snapshot(char **env)
+    {
+        std::size_t size = 0;
+        std::size_t count = 0;
+        for (char **e = env; e && *e; ++e, ++count)
+            size += std::strlen(*e) + 1;
+
+        block.resize(size);
+        envp.reserve(count + 1);
+        char *p = block.empty() ? 0 : &block[0];
+        for (char **e = env; e && *e; ++e)
+        {
+            std::size_t n = std::strlen(*e) + 1;
+            std::memcpy(p, *e, n);
+            const char *eq = std::strchr(p, '=');
+            std::string name(p, eq ? eq - p : n - 1);
+            if (index.insert(std::make_pair(name, envp.size())).second)
+                envp.push_back(p);
+            p += n;
+        }
+        envp.push_back(0);
+    }
+};
+
+}
+
+// An environment block which is cheap to copy and to modify.
+//
+// The variables an environment is constructed with are copied once
+// into a snapshot which all copies share. set() and unset() only
+// record changes in the copy they are called on. envp() builds the
+// pointer array again only after a change. The strings of the snapshot
+// are never copied.
+//
+// environment is not thread-safe. Copies can be used in different
+// threads.
+class environment
+{
+public:
+    environment()
+        : snapshot_(boost::make_shared<detail::environment_snapshot>(
+            static_cast<char**>(0))), dirty_(true) {}
+
+    explicit environment(char **env)
+        : snapshot_(boost::make_shared<detail::environment_snapshot>(env)),
+          dirty_(true) {}
+
+    static environment current()
+    {
+        return environment(environ);
+    }
+
+    environment(const environment &other)
+        : snapshot_(other.snapshot_), changes_(other.changes_), dirty_(true)
+    {
+    }
+
+    environment &operator=(const environment &other)
+    {
+        snapshot_ = other.snapshot_;
+        changes_ = other.changes_;
+        dirty_ = true;
+        return *this;
+    }
+
+    void set(const std::string &name, const std::string &value)
+    {
+        changes_[name] = name + "=" + value;
+        dirty_ = true;
+    }
+
+    void unset(const std::string &name)
+    {
+        if (snapshot_->index.count(name))
+            changes_[name] = boost::none;
+        else
+            changes_.erase(name);
+        dirty_ = true;
+    }
+
+    boost::optional<std::string> get(const std::string &name) const
+    {
+        const char *entry = find(name);
+        if (!entry)
+            return boost::none;
+        return std::string(entry + name.size() + 1);
+    }
+
+    bool has(const std::string &name) const
+    {
+        return find(name) != 0;
+    }
+
+    char **envp() const
+    {
+        if (dirty_)
+            build();
+        return &envp_[0];
+    }
+
+private:
+    typedef boost::unordered_map<std::string,
+        boost::optional<std::string> > change_map;
+    typedef boost::unordered_map<std::string, std::size_t> index_map;
+
+    const char *find(const std::string &name) const
+    {
+        change_map::const_iterator c = changes_.find(name);
+        if (c != changes_.end())
+            return c->second ? c->second->c_str() : 0;
+        index_map::const_iterator i = snapshot_->index.find(name);
+        if (i == snapshot_->index.end())
+            return 0;
+        const char *entry = snapshot_->envp[i->second];
+        return std::strchr(entry, '=') ? entry : 0;
+    }
+
+    void build() const
+    {
+        envp_ = snapshot_->envp;
+        envp_.pop_back();
+        bool removed = false;
+        for (change_map::const_iterator it = changes_.begin();
+            it != changes_.end(); ++it)
+        {
+            char *entry = it->second ?
+                const_cast<char*>(it->second->c_str()) : 0;
+            index_map::const_iterator i = snapshot_->index.find(it->first);
+            if (i != snapshot_->index.end())
+            {
+                envp_[i->second] = entry;
+                removed = removed || !entry;
+            }
+            else if (entry)
+            {
+                envp_.push_back(entry);
+            }
+        }
+        if (removed)
+            envp_.erase(std::remove(envp_.begin(), envp_.end(),
+                static_cast<char*>(0)), envp_.end());
+        envp_.push_back(0);
+        dirty_ = false;
+    }
+
+    boost::shared_ptr<const detail::environment_snapshot> snapshot_;
+    change_map changes_;
+    mutable std::vector<char*> envp_;
+    mutable bool dirty_;
+};
+
+}}}
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_EXEC_STAGE_HPP
+#define BOOST_PROCESS_POSIX_EXEC_STAGE_HPP
+
+namespace boost { namespace process { namespace posix {
+
+// The step in which starting a child process failed.
+enum exec_stage
+{
+    exec_stage_none,
+    exec_stage_fork,
+    exec_stage_spawn,
+    exec_stage_execve,
+    exec_stage_chdir,
+    exec_stage_dup2,
+    exec_stage_close,
+    exec_stage_setpgid,
+    exec_stage_setsid
+};
+
+inline const char *exec_stage_name(exec_stage stage)
+{
+    switch (stage)
+    {
+    case exec_stage_none: return "none";
+    case exec_stage_fork: return "fork";
+    case exec_stage_spawn: return "posix_spawn";
+    case exec_stage_execve: return "execve";
+    case exec_stage_chdir: return "chdir";
+    case exec_stage_dup2: return "dup2";
+    case exec_stage_close: return "close";
+    case exec_stage_setpgid: return "setpgid";
+    case exec_stage_setsid: return "setsid";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+inline const char *exec_stage_what(exec_stage stage)
+{
+    switch (stage)
+    {
+    case exec_stage_fork: return "fork(2) failed";
+    case exec_stage_spawn: return "posix_spawn(3) failed";
+    case exec_stage_chdir: return "chdir(2) failed";
+    case exec_stage_dup2: return "dup2(2) failed";
+    case exec_stage_close: return "close(2) failed";
+    case exec_stage_setpgid: return "setpgid(2) failed";
+    case exec_stage_setsid: return "setsid(2) failed";
+    default: return "execve(2) failed";
+    }
+}
+
+// Sent by the child process over a pipe if it can't call execve or
+// execve fails.
+struct exec_error_message
+{
+    int stage;
+    int error;
+};
+
+}
+
+}}}
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_EXECUTE_BATCH_HPP
+#define BOOST_PROCESS_POSIX_EXECUTE_BATCH_HPP
+
+#include <boost/process/posix/executor.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/wait_for_exit.hpp>
+#include <boost/process/posix/initializers/set_on_error.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/fusion/algorithm/transformation/push_back.hpp>
+#include <boost/fusion/mpl.hpp>
+#include <boost/container/vector.hpp>
+#include <boost/move/move.hpp>
+#include <boost/ref.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace boost { namespace process { namespace posix {
+
+struct batch_result
+{
+    boost::container::vector<child> children;
+    std::vector<boost::system::error_code> errors;
+
+    batch_result() {}
+
+    batch_result(BOOST_RV_REF(batch_result) r)
+        : children(boost::move(r.children)), errors()
+    {
+        errors.swap(r.errors);
+    }
+
+    batch_result &operator=(BOOST_RV_REF(batch_result) r)
+    {
+        children = boost::move(r.children);
+        errors.swap(r.errors);
+        return *this;
+    }
+
+private:
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(batch_result);
+};
+
+namespace detail {
+
+template <class InitializerSequence, class Initializer>
+child execute_one(const InitializerSequence &seq, const Initializer &i,
+    boost::system::error_code &ec)
+{
+    initializers::set_on_error on_error(ec);
+    child c = executor()(boost::fusion::push_back(
+        boost::fusion::push_back(seq, boost::cref(i)),
+        boost::cref(on_error)));
+    // A child whose execve failed has already exited. It is reaped here,
+    // so callers only wait for children which have been started.
+    if (ec && c.pid != -1)
+    {
+        boost::system::error_code ignored;
+        wait_for_exit(c, ignored);
+        return child(-1);
+    }
+    return boost::move(c);
+}
+
+}
+
+template <class InitializerSequence, class Customizer>
+batch_result execute_batch(std::size_t count,
+    const InitializerSequence &prototype, Customizer customize)
+{
+    batch_result r;
+    r.children.reserve(count);
+    r.errors.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        r.children.push_back(
+            detail::execute_one(prototype, customize(i), r.errors[i]));
+    }
+    return boost::move(r);
+}
+
+}}}
+
+#endif
@@ -11,16 +11,66 @@
 #define BOOST_PROCESS_POSIX_EXECUTOR_HPP
 
 #include <boost/process/posix/child.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/process/posix/fork_server.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
 #include <boost/fusion/algorithm/iteration/for_each.hpp>
+#include <boost/fusion/mpl.hpp>
+#include <boost/mpl/find_if.hpp>
+#include <boost/mpl/end.hpp>
+#include <boost/mpl/not.hpp>
+#include <boost/mpl/placeholders.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/remove_reference.hpp>
 #include <cstdlib>
+#include <vector>
 #include <sys/types.h>
 #include <unistd.h>
+#include <spawn.h>
+#include <errno.h>
+
+#if defined(__linux__) && !defined(BOOST_PROCESS_POSIX_NO_VFORK)
+#   define BOOST_PROCESS_POSIX_USE_VFORK
+#endif
 
 namespace boost { namespace process { namespace posix {
 
+template <class InitializerSequence, template <class> class Trait>
+struct all_initializers : boost::is_same<
+    typename boost::mpl::find_if<InitializerSequence,
+        boost::mpl::not_<Trait<boost::remove_cv<
+            boost::remove_reference<boost::mpl::_1> > > >
+    >::type,
+    typename boost::mpl::end<InitializerSequence>::type
+> {};
+
+template <class InitializerSequence, template <class> class Trait>
+struct any_initializer : boost::integral_constant<bool, !boost::is_same<
+    typename boost::mpl::find_if<InitializerSequence,
+        Trait<boost::remove_cv<boost::remove_reference<boost::mpl::_1> > >
+    >::type,
+    typename boost::mpl::end<InitializerSequence>::type
+>::value> {};
+
+template <class InitializerSequence>
+struct is_spawnable_sequence :
+    all_initializers<InitializerSequence, initializers::is_spawnable> {};
+
+template <class InitializerSequence>
+struct is_vfork_safe_sequence :
+    all_initializers<InitializerSequence, initializers::is_vfork_safe> {};
+
 struct executor
 {
-    executor() : exe(0), cmd_line(0), env(0) {}
+    executor() : exe(0), cmd_line(0), env(0), file_actions(0), attr(0),
+        pid(-1), failed_stage(exec_stage_none), failed_errno(0)
+#if defined(BOOST_PROCESS_POSIX_HAS_FORK_SERVER)
+        , request(0)
+#endif
+    {}
 
     struct call_on_fork_setup
     {
@@ -87,32 +137,286 @@ struct executor
         }
     };
 
+    struct call_on_spawn_setup
+    {
+        executor &e_;
+
+        call_on_spawn_setup(executor &e) : e_(e) {}
+
+        template <class Arg>
+        void operator()(const Arg &arg) const
+        {
+            arg.on_spawn_setup(e_);
+        }
+    };
+
+    struct call_on_spawn_error
+    {
+        executor &e_;
+
+        call_on_spawn_error(executor &e) : e_(e) {}
+
+        template <class Arg>
+        void operator()(Arg &arg) const
+        {
+            arg.on_spawn_error(e_);
+        }
+    };
+
+    struct call_on_spawn_success
+    {
+        executor &e_;
+
+        call_on_spawn_success(executor &e) : e_(e) {}
+
+        template <class Arg>
+        void operator()(Arg &arg) const
+        {
+            arg.on_spawn_success(e_);
+        }
+    };
+
+    struct call_on_fork_server_setup
+    {
+        executor &e_;
+
+        call_on_fork_server_setup(executor &e) : e_(e) {}
+
+        template <class Arg>
+        void operator()(const Arg &arg) const
+        {
+            arg.on_fork_server_setup(e_);
+        }
+    };
+
     template <class InitializerSequence>
     child operator()(const InitializerSequence &seq)
     {
+        return launch(seq, any_initializer<InitializerSequence,
+            initializers::uses_fork_server>());
+    }
+
+    const char *exe;
+    char **cmd_line;
+    char **env;
+    posix_spawn_file_actions_t *file_actions;
+    posix_spawnattr_t *attr;
+    pid_t pid;
+    exec_stage failed_stage;
+    int failed_errno;
+#if defined(BOOST_PROCESS_POSIX_HAS_FORK_SERVER)
+    detail::fork_server_request *request;
+#endif
+
+    // Called in the child process by initializers whose step before
+    // execve fails. execve is skipped and on_exec_error is called with
+    // errno set to the error of the first failed step.
+    void exec_failed(exec_stage stage)
+    {
+        if (failed_stage == exec_stage_none)
+        {
+            failed_stage = stage;
+            failed_errno = errno;
+        }
+    }
+
+    // Called in the parent process by initializers in on_spawn_setup to
+    // close a file descriptor in the child process. The file descriptors
+    // are closed after all other file actions, so initializers which dup2
+    // them work no matter in which order they are passed to execute.
+    void spawn_close(int fd)
+    {
+        spawn_closes_.push_back(fd);
+    }
+
+private:
+    std::vector<int> spawn_closes_;
+
+    class spawn_data
+    {
+    public:
+        spawn_data() : ec_(::posix_spawn_file_actions_init(&file_actions_))
+        {
+            if (!ec_)
+            {
+                ec_ = ::posix_spawnattr_init(&attr_);
+                if (ec_)
+                    ::posix_spawn_file_actions_destroy(&file_actions_);
+            }
+        }
+
+        ~spawn_data()
+        {
+            if (!ec_)
+            {
+                ::posix_spawnattr_destroy(&attr_);
+                ::posix_spawn_file_actions_destroy(&file_actions_);
+            }
+        }
+
+        int error() const { return ec_; }
+        posix_spawn_file_actions_t *file_actions() { return &file_actions_; }
+        posix_spawnattr_t *attr() { return &attr_; }
+
+    private:
+        spawn_data(const spawn_data&);
+        spawn_data &operator=(const spawn_data&);
+
+        int ec_;
+        posix_spawn_file_actions_t file_actions_;
+        posix_spawnattr_t attr_;
+    };
+
+    template <class InitializerSequence>
+    child launch(const InitializerSequence &seq, boost::false_type)
+    {
+        return launch(seq, is_spawnable_sequence<InitializerSequence>(),
+            is_vfork_safe_sequence<InitializerSequence>());
+    }
+
+#if defined(BOOST_PROCESS_POSIX_HAS_FORK_SERVER)
+    // The program is started by a fork server. Errors are reported like
+    // errors of posix_spawn.
+    template <class InitializerSequence>
+    child launch(const InitializerSequence &seq, boost::true_type)
+    {
+        BOOST_STATIC_ASSERT_MSG((all_initializers<InitializerSequence,
+            initializers::is_fork_server_compatible>::value),
+            "initializer can't be used with a fork server");
+
+        detail::fork_server_request req;
+        request = &req;
+        boost::fusion::for_each(seq, call_on_fork_server_setup(*this));
+        request = 0;
+
+        pid = -1;
+        errno = EINVAL;
+        failed_stage = exec_stage_spawn;
+        if (req.server)
+            pid = req.server->spawn(req, exe, cmd_line, env, failed_stage);
+
+        if (pid == -1)
+        {
+            failed_errno = errno;
+            boost::fusion::for_each(seq, call_on_spawn_error(*this));
+        }
+        else
+        {
+            boost::fusion::for_each(seq, call_on_spawn_success(*this));
+        }
+
+        return make_child(pid);
+    }
+#endif
+
+    template <class InitializerSequence, class VforkSafe>
+    child launch(const InitializerSequence &seq, boost::true_type, VforkSafe)
+    {
+        spawn_data data;
+        pid = -1;
+        int ec = data.error();
+        if (!ec)
+        {
+            file_actions = data.file_actions();
+            attr = data.attr();
+#if defined(POSIX_SPAWN_USEVFORK)
+            ::posix_spawnattr_setflags(attr, POSIX_SPAWN_USEVFORK);
+#endif
+            spawn_closes_.clear();
+            boost::fusion::for_each(seq, call_on_spawn_setup(*this));
+            for (std::vector<int>::const_iterator it = spawn_closes_.begin();
+                it != spawn_closes_.end(); ++it)
+                ::posix_spawn_file_actions_addclose(file_actions, *it);
+            ec = ::posix_spawn(&pid, exe, file_actions, attr, cmd_line, env);
+            file_actions = 0;
+            attr = 0;
+        }
+
+        if (ec)
+        {
+            pid = -1;
+            errno = ec;
+            failed_stage = exec_stage_spawn;
+            failed_errno = ec;
+            boost::fusion::for_each(seq, call_on_spawn_error(*this));
+        }
+        else
+        {
+            boost::fusion::for_each(seq, call_on_spawn_success(*this));
+        }
+
+        return make_child(pid);
+    }
+
+    template <class InitializerSequence>
+    void exec_child(const InitializerSequence &seq)
+    {
+        boost::fusion::for_each(seq, call_on_exec_setup(*this));
+        if (failed_stage == exec_stage_none)
+        {
+            ::execve(exe, cmd_line, env);
+            failed_stage = exec_stage_execve;
+            failed_errno = errno;
+        }
+        else
+        {
+            errno = failed_errno;
+        }
+        boost::fusion::for_each(seq, call_on_exec_error(*this));
+        _exit(EXIT_FAILURE);
+    }
+
+    template <class InitializerSequence>
+    child launch(const InitializerSequence &seq, boost::false_type,
+        boost::false_type)
+    {
+        failed_stage = exec_stage_none;
         boost::fusion::for_each(seq, call_on_fork_setup(*this));
 
-        pid_t pid = ::fork();
+        pid = ::fork();
         if (pid == -1)
         {
+            exec_failed(exec_stage_fork);
             boost::fusion::for_each(seq, call_on_fork_error(*this));
         }
         else if (pid == 0)
         {
-            boost::fusion::for_each(seq, call_on_exec_setup(*this));
-            ::execve(exe, cmd_line, env);
-            boost::fusion::for_each(seq, call_on_exec_error(*this));
-            _exit(EXIT_FAILURE);
+            exec_child(seq);
         }
 
         boost::fusion::for_each(seq, call_on_fork_success(*this));
 
-        return child(pid);
+        return make_child(pid);
     }
 
-    const char *exe;
-    char **cmd_line;
-    char **env;
+    template <class InitializerSequence>
+    child launch(const InitializerSequence &seq, boost::false_type,
+        boost::true_type)
+    {
+        failed_stage = exec_stage_none;
+        boost::fusion::for_each(seq, call_on_fork_setup(*this));
+
+        // The child borrows the parent's memory until execve or _exit
+        // is called. It must not return from this function.
+#if defined(BOOST_PROCESS_POSIX_USE_VFORK)
+        pid = ::vfork();
+#else
+        pid = ::fork();
+#endif
+        if (pid == -1)
+        {
+            exec_failed(exec_stage_fork);
+            boost::fusion::for_each(seq, call_on_fork_error(*this));
+        }
+        else if (pid == 0)
+        {
+            exec_child(seq);
+        }
+
+        boost::fusion::for_each(seq, call_on_fork_success(*this));
+
+        return make_child(pid);
+    }
 };
 
 }}}
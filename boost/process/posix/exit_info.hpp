@@ -0,0 +1,40 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_EXIT_INFO_HPP
+#define BOOST_PROCESS_POSIX_EXIT_INFO_HPP
+
+#include <cstring>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+namespace boost { namespace process { namespace posix {
+
+struct exit_info
+{
+    int status;
+    int exit_code;
+    int signal;
+    struct rusage usage;
+
+    exit_info() : status(0), exit_code(-1), signal(0)
+    {
+        std::memset(&usage, 0, sizeof(usage));
+    }
+
+    exit_info(int s, const struct rusage &ru)
+        : status(s), exit_code(WIFEXITED(s) ? WEXITSTATUS(s) : -1),
+        signal(WIFSIGNALED(s) ? WTERMSIG(s) : 0), usage(ru) {}
+};
+
+}}}
+
+#endif
@@ -0,0 +1,290 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_FEED_STDIN_HPP
+#define BOOST_PROCESS_POSIX_FEED_STDIN_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/forward.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+enum feed_flags
+{
+    feed_default = 0,
+    feed_zero_copy = 1,
+    feed_gift = 3
+};
+
+namespace detail {
+
+// Remaining data of a buffer sequence. By default the data is copied with
+// writev(2). With feed_zero_copy vmsplice(2) maps the pages of the
+// buffers into the pipe instead of copying them. With SPLICE_F_GIFT the
+// kernel may even steal the pages, which requires that every buffer starts
+// at a page boundary and is a multiple of the page size. If the sink isn't
+// a pipe vmsplice(2) fails with EBADF and writev(2) is used instead (an
+// invalid sink then fails in writev(2) with the same error).
+struct feed_state
+{
+    std::vector<struct iovec> iov;
+    std::size_t index;
+    std::size_t total;
+    bool use_vmsplice;
+    bool gift;
+
+    template <class ConstBufferSequence>
+    feed_state(const ConstBufferSequence &buffers, int flags)
+        : index(0), total(0), use_vmsplice((flags & feed_zero_copy) != 0),
+          gift((flags & feed_gift) == feed_gift)
+    {
+        add(boost::asio::buffer_sequence_begin(buffers),
+            boost::asio::buffer_sequence_end(buffers));
+    }
+
+    // Takes iterators as a single const_buffer is a buffer sequence, too,
+    // but has no const_iterator.
+    template <class Iterator>
+    void add(Iterator it, Iterator end)
+    {
+        long page_size = ::sysconf(_SC_PAGESIZE);
+        for (; it != end; ++it)
+        {
+            boost::asio::const_buffer buffer(*it);
+            std::size_t size = boost::asio::buffer_size(buffer);
+            if (size == 0)
+                continue;
+            struct iovec v;
+            v.iov_base = const_cast<void*>(
+                boost::asio::buffer_cast<const void*>(buffer));
+            v.iov_len = size;
+            if (reinterpret_cast<std::size_t>(v.iov_base) % page_size != 0 ||
+                size % page_size != 0)
+                gift = false;
+            iov.push_back(v);
+        }
+    }
+
+    bool done() const { return index == iov.size(); }
+
+    // Returns the number of bytes written or -1 on error. A partial
+    // vmsplice(2) or writev(2) leaves index and iov_base pointing to the
+    // first byte which hasn't been written yet.
+    ssize_t feed_some(int sink, bool nonblocking)
+    {
+        int count = static_cast<int>(
+            (std::min)(iov.size() - index, std::size_t(IOV_MAX)));
+        ssize_t n = -1;
+#if defined(BOOST_PROCESS_POSIX_HAS_SPLICE)
+        if (use_vmsplice)
+        {
+            unsigned int flags = 0;
+            if (nonblocking)
+                flags |= SPLICE_F_NONBLOCK;
+            if (gift)
+                flags |= SPLICE_F_GIFT;
+            do
+            {
+                n = ::vmsplice(sink, &iov[index], count, flags);
+            } while (n == -1 && errno == EINTR);
+            if (n == -1 &&
+                (errno == EBADF || errno == EINVAL || errno == ENOSYS))
+                use_vmsplice = false;
+        }
+#else
+        (void)nonblocking;
+        use_vmsplice = false;
+#endif
+        if (!use_vmsplice)
+        {
+            do
+            {
+                n = ::writev(sink, &iov[index], count);
+            } while (n == -1 && errno == EINTR);
+        }
+        if (n > 0)
+            advance(n);
+        return n;
+    }
+
+    void advance(std::size_t n)
+    {
+        total += n;
+        while (n > 0 && n >= iov[index].iov_len)
+            n -= iov[index++].iov_len;
+        if (n > 0)
+        {
+            iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + n;
+            iov[index].iov_len -= n;
+            // A partially moved page can't be a gift anymore.
+            gift = false;
+        }
+    }
+};
+
+template <class Handler>
+struct feed_op
+{
+    boost::asio::posix::stream_descriptor descriptor;
+    feed_state state;
+    Handler handler;
+    int status_flags;
+
+    template <class ConstBufferSequence>
+    feed_op(boost::asio::io_service &io_service, int fd,
+        const ConstBufferSequence &buffers, int flags, Handler h,
+        int status)
+        : descriptor(io_service, fd), state(buffers, flags), handler(h),
+          status_flags(status) {}
+
+    // The file descriptor is a duplicate of the caller's, so O_NONBLOCK
+    // set on it applies to the caller's file descriptor, too. The flags
+    // are restored before the handler is called.
+    void complete(const boost::system::error_code &ec)
+    {
+        ::fcntl(descriptor.native_handle(), F_SETFL, status_flags);
+        handler(ec, state.total);
+    }
+};
+
+template <class Handler>
+struct feed_handler
+{
+    boost::shared_ptr<feed_op<Handler> > op_;
+
+    explicit feed_handler(const boost::shared_ptr<feed_op<Handler> > &op)
+        : op_(op) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t)
+    {
+        if (ec)
+        {
+            op_->complete(ec);
+            return;
+        }
+
+        // The sink is non-blocking, so data is written until the pipe is
+        // full or everything has been written.
+        ssize_t n = 0;
+        while (!op_->state.done() && (n = op_->state.feed_some(
+            op_->descriptor.native_handle(), true)) > 0)
+            ;
+
+        if (op_->state.done())
+        {
+            op_->complete(boost::system::error_code());
+        }
+        else if (n == -1 && errno != EAGAIN)
+        {
+            boost::system::error_code feed_ec;
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(feed_ec);
+            op_->complete(feed_ec);
+        }
+        else
+        {
+            op_->descriptor.async_write_some(boost::asio::null_buffers(),
+                *this);
+        }
+    }
+};
+
+}
+
+template <class ConstBufferSequence>
+std::size_t feed_stdin(int sink, const ConstBufferSequence &buffers,
+    int flags = feed_default)
+{
+    detail::feed_state state(buffers, flags);
+    while (!state.done())
+    {
+        if (state.feed_some(sink, false) == -1)
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("feed_stdin() failed");
+    }
+    return state.total;
+}
+
+template <class ConstBufferSequence>
+std::size_t feed_stdin(int sink, const ConstBufferSequence &buffers,
+    int flags, boost::system::error_code &ec)
+{
+    detail::feed_state state(buffers, flags);
+    ec.clear();
+    while (!state.done())
+    {
+        if (state.feed_some(sink, false) == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            break;
+        }
+    }
+    return state.total;
+}
+
+template <class ConstBufferSequence>
+std::size_t feed_stdin(int sink, const ConstBufferSequence &buffers,
+    boost::system::error_code &ec)
+{
+    return feed_stdin(sink, buffers, feed_default, ec);
+}
+
+template <class ConstBufferSequence, class Handler>
+void async_feed_stdin(boost::asio::io_service &io_service, int sink,
+    const ConstBufferSequence &buffers, int flags, Handler handler)
+{
+    int status = ::fcntl(sink, F_GETFL);
+    int fd = status == -1 ? -1 : ::fcntl(sink, F_DUPFD_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        io_service.post(boost::bind<void>(handler, ec, std::size_t(0)));
+        return;
+    }
+
+    boost::shared_ptr<detail::feed_op<Handler> > op(
+        new detail::feed_op<Handler>(io_service, fd, buffers, flags,
+            handler, status));
+    boost::system::error_code ec;
+    op->descriptor.non_blocking(true, ec);
+    if (ec)
+    {
+        op.reset();
+        ::fcntl(sink, F_SETFL, status);
+        io_service.post(boost::bind<void>(handler, ec, std::size_t(0)));
+        return;
+    }
+    op->descriptor.async_write_some(boost::asio::null_buffers(),
+        detail::feed_handler<Handler>(op));
+}
+
+template <class ConstBufferSequence, class Handler>
+void async_feed_stdin(boost::asio::io_service &io_service, int sink,
+    const ConstBufferSequence &buffers, Handler handler)
+{
+    async_feed_stdin(io_service, sink, buffers, feed_default, handler);
+}
+
+}}}
+
+#endif
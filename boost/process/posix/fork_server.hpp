@@ -0,0 +1,525 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_FORK_SERVER_HPP
+#define BOOST_PROCESS_POSIX_FORK_SERVER_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/process/posix/detail/open_fds.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <errno.h>
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_clone) && defined(CLONE_PARENT)
+#   define BOOST_PROCESS_POSIX_HAS_FORK_SERVER
+#endif
+
+#ifndef BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS
+#   define BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS 64
+#endif
+
+#if defined(BOOST_PROCESS_POSIX_HAS_FORK_SERVER)
+
+namespace boost { namespace process { namespace posix {
+
+class fork_server;
+
+namespace detail {
+
+// Describes a program to be started by a fork server. Initializers fill
+// it in on_fork_server_setup(). The standard streams are passed to the
+// child process by default like they are inherited with fork().
+struct fork_server_request
+{
+    enum { new_process_group = 1, new_session = 2 };
+
+    fork_server *server;
+    const char *work_dir;
+    int flags;
+    std::vector<std::pair<int, int> > fds;
+
+    fork_server_request() : server(0), work_dir(0), flags(0)
+    {
+        for (int fd = 0; fd < 3; ++fd)
+        {
+            if (::fcntl(fd, F_GETFD) != -1)
+                fds.push_back(std::make_pair(fd, fd));
+        }
+    }
+
+    struct is_target
+    {
+        int target;
+
+        explicit is_target(int t) : target(t) {}
+
+        bool operator()(int fd) const { return fd == target; }
+    };
+
+    void bind(int fd, int target)
+    {
+        close(target);
+        fds.push_back(std::make_pair(target, fd));
+    }
+
+    void close(int target)
+    {
+        close_if(is_target(target));
+    }
+
+    template <class Predicate>
+    void close_if(const Predicate &pred)
+    {
+        for (std::size_t i = 0; i < fds.size();)
+        {
+            if (pred(fds[i].first))
+                fds.erase(fds.begin() + i);
+            else
+                ++i;
+        }
+    }
+};
+
+struct fork_server_header
+{
+    boost::uint32_t size;
+    boost::int32_t argc;
+    boost::int32_t envc;
+    boost::int32_t nfds;
+    boost::int32_t flags;
+};
+
+struct fork_server_reply
+{
+    boost::int32_t pid;
+    boost::int32_t error;
+    boost::int32_t stage;
+};
+
+inline bool read_all(int fd, void *data, std::size_t size)
+{
+    char *p = static_cast<char*>(data);
+    while (size > 0)
+    {
+        ssize_t n = ::read(fd, p, size);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+inline bool send_all(int fd, const void *data, std::size_t size)
+{
+    const char *p = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n == -1)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Starts the requested program as a sibling of the fork server, so it is
+// a child of the process which owns the fork server. Returns the process
+// ID or -1 and sets error to errno of the failed system call and stage to
+// the step which failed.
+inline pid_t fork_server_spawn(const fork_server_header &h,
+    const std::vector<int> &targets, int *fds, const char *exe,
+    const char *work_dir, char **argv, char **envp, exec_error_message &error)
+{
+    error.stage = exec_stage_none;
+    error.error = 0;
+
+    int errpipe[2];
+    if (::pipe2(errpipe, O_CLOEXEC) == -1)
+    {
+        error.stage = exec_stage_spawn;
+        error.error = errno;
+        return -1;
+    }
+
+    pid_t pid = static_cast<pid_t>(
+        ::syscall(SYS_clone, CLONE_PARENT | SIGCHLD, 0, 0, 0, 0));
+    if (pid == 0)
+    {
+        exec_error_message m;
+        m.stage = exec_stage_none;
+        if (h.flags & fork_server_request::new_process_group &&
+            ::setpgid(0, 0) == -1)
+            m.stage = exec_stage_setpgid;
+        if (!m.stage && h.flags & fork_server_request::new_session &&
+            ::setsid() == -1)
+            m.stage = exec_stage_setsid;
+
+        // Move the received descriptors out of the way of the targets
+        // first. All descriptors in the fork server are FD_CLOEXEC.
+        int low = *std::max_element(targets.begin(), targets.end()) + 1;
+        int err = ::fcntl(errpipe[1], F_DUPFD_CLOEXEC, low);
+        if (err == -1)
+            _exit(EXIT_FAILURE);
+        for (int i = 0; !m.stage && i < h.nfds; ++i)
+        {
+            fds[i] = ::fcntl(fds[i], F_DUPFD_CLOEXEC, low);
+            if (fds[i] == -1)
+                m.stage = exec_stage_dup2;
+        }
+        for (int i = 0; !m.stage && i < h.nfds; ++i)
+        {
+            if (dup_fd(fds[i], targets[i]) == -1)
+                m.stage = exec_stage_dup2;
+        }
+
+        if (!m.stage && *work_dir && ::chdir(work_dir) == -1)
+            m.stage = exec_stage_chdir;
+        if (!m.stage)
+        {
+            ::execve(exe, argv, envp);
+            m.stage = exec_stage_execve;
+        }
+        m.error = errno;
+        while (::write(err, &m, sizeof(m)) == -1 && errno == EINTR)
+            ;
+        _exit(EXIT_FAILURE);
+    }
+
+    if (pid == -1)
+    {
+        error.stage = exec_stage_fork;
+        error.error = errno;
+    }
+    ::close(errpipe[1]);
+    if (pid != -1)
+    {
+        exec_error_message m;
+        ssize_t n;
+        do
+        {
+            n = ::read(errpipe[0], &m, sizeof(m));
+        } while (n == -1 && errno == EINTR);
+        if (n == sizeof(m))
+            error = m;
+    }
+    ::close(errpipe[0]);
+    return pid;
+}
+
+// Main loop of the fork server. Returns when the socket is closed.
+inline void fork_server_serve(int sock)
+{
+    for (;;)
+    {
+        fork_server_header h;
+        union
+        {
+            char buffer[CMSG_SPACE(sizeof(int) *
+                BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS)];
+            struct cmsghdr align;
+        } control;
+        struct iovec iov;
+        iov.iov_base = &h;
+        iov.iov_len = sizeof(h);
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+
+        ssize_t n;
+        do
+        {
+            n = ::recvmsg(sock, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+        } while (n == -1 && errno == EINTR);
+        if (n != sizeof(h))
+            return;
+
+        int fds[BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS];
+        int nfds = 0;
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c;
+            c = CMSG_NXTHDR(&msg, c))
+        {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+            {
+                nfds = static_cast<int>(
+                    (c->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                std::memcpy(fds, CMSG_DATA(c), nfds * sizeof(int));
+            }
+        }
+
+        std::vector<char> payload(h.size + 1);
+        if (!read_all(sock, &payload[0], h.size))
+            return;
+        payload[h.size] = '\0';
+
+        fork_server_reply reply;
+        reply.pid = -1;
+        reply.error = EINVAL;
+        reply.stage = exec_stage_spawn;
+        if (nfds == h.nfds && h.argc >= 0 &&
+            h.size >= h.nfds * sizeof(boost::int32_t))
+        {
+            std::vector<int> targets(h.nfds ? h.nfds : 1, 0);
+            std::memcpy(&targets[0], &payload[0],
+                h.nfds * sizeof(boost::int32_t));
+
+            std::vector<char*> strings;
+            for (std::size_t i = h.nfds * sizeof(boost::int32_t);
+                i < h.size; i += std::strlen(&payload[i]) + 1)
+                strings.push_back(&payload[i]);
+
+            if (h.envc >= 0 && strings.size() == static_cast<std::size_t>(
+                2 + h.argc + h.envc))
+            {
+                std::vector<char*> argv(strings.begin() + 2,
+                    strings.begin() + 2 + h.argc);
+                argv.push_back(0);
+                std::vector<char*> envp(strings.begin() + 2 + h.argc,
+                    strings.end());
+                envp.push_back(0);
+                exec_error_message error;
+                reply.pid = fork_server_spawn(h, targets, fds, strings[0],
+                    strings[1], &argv[0], &envp[0], error);
+                reply.error = error.error;
+                reply.stage = error.stage;
+            }
+        }
+
+        for (int i = 0; i < nfds; ++i)
+            ::close(fds[i]);
+        if (!send_all(sock, &reply, sizeof(reply)))
+            return;
+    }
+}
+
+}
+
+class fork_server
+{
+public:
+    fork_server() : pid_(-1), sock_(-1) {}
+
+    ~fork_server()
+    {
+        stop();
+    }
+
+    void start()
+    {
+        boost::system::error_code ec;
+        start(ec);
+        if (ec)
+            BOOST_PROCESS_THROW(boost::system::system_error(ec,
+                BOOST_PROCESS_SOURCE_LOCATION "fork_server::start() failed"));
+    }
+
+    void start(boost::system::error_code &ec)
+    {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            return;
+        }
+
+        pid_t pid = ::fork();
+        if (pid == -1)
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return;
+        }
+
+        if (pid == 0)
+        {
+            // Keep only the socket so that pipes the parent opened don't
+            // stay open as long as the fork server runs.
+            ::close(fds[0]);
+            int sock = ::fcntl(fds[1], F_DUPFD_CLOEXEC, 3);
+            if (sock == -1)
+                _exit(EXIT_FAILURE);
+            bool closed = false;
+#if defined(BOOST_PROCESS_POSIX_HAS_CLOSE_RANGE)
+            closed = ::syscall(SYS_close_range, 0, sock - 1, 0) == 0 &&
+                ::syscall(SYS_close_range, sock + 1, ~0U, 0) == 0;
+#endif
+            int up = closed ? 0 : detail::max_fd();
+            for (int fd = 0; fd < up; ++fd)
+            {
+                if (fd != sock)
+                    ::close(fd);
+            }
+            detail::fork_server_serve(sock);
+            _exit(EXIT_SUCCESS);
+        }
+
+        ::close(fds[1]);
+        stop();
+        pid_ = pid;
+        sock_ = fds[0];
+        ec.clear();
+    }
+
+    void stop()
+    {
+        if (sock_ != -1)
+        {
+            ::close(sock_);
+            sock_ = -1;
+            while (::waitpid(pid_, 0, 0) == -1 && errno == EINTR)
+                ;
+            pid_ = -1;
+        }
+    }
+
+    bool running() const { return sock_ != -1; }
+
+    pid_t pid() const { return pid_; }
+
+    // Returns the process ID of the new child process or -1 and sets errno.
+    pid_t spawn(const detail::fork_server_request &req, const char *exe,
+        char **cmd_line, char **env)
+    {
+        exec_stage stage;
+        return spawn(req, exe, cmd_line, env, stage);
+    }
+
+    // Like above. Sets stage to the step which failed.
+    pid_t spawn(const detail::fork_server_request &req, const char *exe,
+        char **cmd_line, char **env, exec_stage &stage)
+    {
+        stage = exec_stage_spawn;
+        if (sock_ == -1 || !exe || !cmd_line ||
+            req.fds.size() > BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS)
+        {
+            errno = sock_ == -1 ? EBADF : EINVAL;
+            return -1;
+        }
+
+        std::string payload;
+        for (std::size_t i = 0; i < req.fds.size(); ++i)
+        {
+            boost::int32_t target = req.fds[i].first;
+            payload.append(reinterpret_cast<const char*>(&target),
+                sizeof(target));
+        }
+        payload.append(exe).push_back('\0');
+        payload.append(req.work_dir ? req.work_dir : "").push_back('\0');
+        detail::fork_server_header h;
+        h.argc = 0;
+        for (char **arg = cmd_line; *arg; ++arg, ++h.argc)
+            payload.append(*arg).push_back('\0');
+        h.envc = 0;
+        for (char **var = env; var && *var; ++var, ++h.envc)
+            payload.append(*var).push_back('\0');
+        h.size = static_cast<boost::uint32_t>(payload.size());
+        h.nfds = static_cast<boost::int32_t>(req.fds.size());
+        h.flags = req.flags;
+
+        union
+        {
+            char buffer[CMSG_SPACE(sizeof(int) *
+                BOOST_PROCESS_POSIX_FORK_SERVER_MAX_FDS)];
+            struct cmsghdr align;
+        } control;
+        struct iovec iov;
+        iov.iov_base = &h;
+        iov.iov_len = sizeof(h);
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (!req.fds.empty())
+        {
+            msg.msg_control = control.buffer;
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * req.fds.size());
+            struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+            c->cmsg_level = SOL_SOCKET;
+            c->cmsg_type = SCM_RIGHTS;
+            c->cmsg_len = CMSG_LEN(sizeof(int) * req.fds.size());
+            int *data = reinterpret_cast<int*>(CMSG_DATA(c));
+            for (std::size_t i = 0; i < req.fds.size(); ++i)
+                data[i] = req.fds[i].second;
+        }
+
+        ssize_t n;
+        do
+        {
+            n = ::sendmsg(sock_, &msg, MSG_NOSIGNAL);
+        } while (n == -1 && errno == EINTR);
+        if (n != sizeof(h) ||
+            !detail::send_all(sock_, payload.data(), payload.size()))
+        {
+            return -1;
+        }
+
+        detail::fork_server_reply reply;
+        if (!detail::read_all(sock_, &reply, sizeof(reply)))
+        {
+            errno = EPIPE;
+            return -1;
+        }
+        if (reply.error)
+        {
+            // The child is ours even if it failed before execve().
+            if (reply.pid != -1)
+            {
+                while (::waitpid(reply.pid, 0, 0) == -1 && errno == EINTR)
+                    ;
+            }
+            stage = static_cast<exec_stage>(reply.stage);
+            errno = reply.error;
+            return -1;
+        }
+        stage = exec_stage_none;
+        return reply.pid;
+    }
+
+private:
+    fork_server(const fork_server&);
+    fork_server &operator=(const fork_server&);
+
+    pid_t pid_;
+    int sock_;
+};
+
+}}}
+
+#endif
+
+#endif
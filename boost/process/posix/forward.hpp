@@ -0,0 +1,443 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_FORWARD_HPP
+#define BOOST_PROCESS_POSIX_FORWARD_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/write_all.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+
+#if defined(__linux__) && defined(SPLICE_F_MOVE)
+#   define BOOST_PROCESS_POSIX_HAS_SPLICE
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+// Moves one chunk from source to sink. Returns the number of bytes moved,
+// 0 at end of file and -1 on error. splice(2) requires that one of the
+// file descriptors is a pipe and fails with EINVAL for some file types
+// (e.g. files opened with O_APPEND on older kernels). Then use_splice is
+// cleared and the data is copied with read(2) and write(2).
+inline ssize_t forward_some(int source, int sink, bool &use_splice)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_SPLICE)
+    if (use_splice)
+    {
+        ssize_t n;
+        do
+        {
+            n = ::splice(source, 0, sink, 0, 64 * 1024,
+                SPLICE_F_MOVE | SPLICE_F_MORE);
+        } while (n == -1 && errno == EINTR);
+        if (n != -1 || (errno != EINVAL && errno != ENOSYS))
+            return n;
+        use_splice = false;
+    }
+#else
+    use_splice = false;
+#endif
+
+    char buffer[16 * 1024];
+    ssize_t n;
+    do
+    {
+        n = ::read(source, buffer, sizeof(buffer));
+    } while (n == -1 && errno == EINTR);
+    if (n > 0 && !write_all(sink, buffer, n))
+        return -1;
+    return n;
+}
+
+// Moves size bytes, which tee(2) has already copied, from source to sink.
+inline bool forward_exactly(int source, int sink, std::size_t size,
+    bool &use_splice)
+{
+    while (size > 0)
+    {
+        ssize_t n;
+#if defined(BOOST_PROCESS_POSIX_HAS_SPLICE)
+        if (use_splice)
+        {
+            do
+            {
+                n = ::splice(source, 0, sink, 0, size,
+                    SPLICE_F_MOVE | SPLICE_F_MORE);
+            } while (n == -1 && errno == EINTR);
+            if (n > 0)
+            {
+                size -= n;
+                continue;
+            }
+            if (n == -1 && errno != EINVAL && errno != ENOSYS)
+                return false;
+            use_splice = false;
+        }
+#endif
+        char buffer[16 * 1024];
+        do
+        {
+            n = ::read(source, buffer, std::min(size, sizeof(buffer)));
+        } while (n == -1 && errno == EINTR);
+        if (n <= 0 || !write_all(sink, buffer, n))
+            return false;
+        size -= n;
+    }
+    return true;
+}
+
+// Like forward_some() but also copies the data to copy. tee(2) requires
+// that both source and copy are pipes. It doesn't consume the data, so it
+// is spliced to sink afterwards. If tee(2) fails with EINVAL, use_tee is
+// cleared and the data is copied with read(2) and written twice.
+inline ssize_t forward_some(int source, int sink, int copy, bool &use_tee,
+    bool &use_splice)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_SPLICE)
+    if (use_tee)
+    {
+        ssize_t n;
+        do
+        {
+            n = ::tee(source, copy, 64 * 1024, 0);
+        } while (n == -1 && errno == EINTR);
+        if (n > 0 && !forward_exactly(source, sink, n, use_splice))
+            return -1;
+        if (n != -1 || (errno != EINVAL && errno != ENOSYS))
+            return n;
+        use_tee = false;
+    }
+#else
+    use_tee = false;
+    use_splice = false;
+#endif
+
+    char buffer[16 * 1024];
+    ssize_t n;
+    do
+    {
+        n = ::read(source, buffer, sizeof(buffer));
+    } while (n == -1 && errno == EINTR);
+    if (n > 0 && (!write_all(sink, buffer, n) || !write_all(copy, buffer, n)))
+        return -1;
+    return n;
+}
+
+// Returns true if the sink has space. splice(2) fails with EAGAIN both if
+// the source is empty and if the sink is full.
+inline bool sink_writable(int sink)
+{
+    pollfd pfd;
+    pfd.fd = sink;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int n;
+    do
+    {
+        n = ::poll(&pfd, 1, 0);
+    } while (n == -1 && errno == EINTR);
+    return n != 0;
+}
+
+template <class Handler>
+struct forward_op
+{
+    boost::asio::posix::stream_descriptor descriptor;
+    boost::asio::posix::stream_descriptor sink_descriptor;
+    int sink;
+    Handler handler;
+    std::size_t total;
+    bool use_splice;
+    bool source_readable;
+    std::vector<char> buffer;
+    std::size_t begin;
+    std::size_t end;
+    int source_flags;
+    int sink_flags;
+
+    forward_op(boost::asio::io_service &io_service, int fd, int sink_fd,
+        Handler h, int source_status, int sink_status)
+        : descriptor(io_service, fd), sink_descriptor(io_service, sink_fd),
+          sink(sink_fd), handler(h), total(0), use_splice(true),
+          source_readable(false), buffer(16 * 1024), begin(0), end(0),
+          source_flags(source_status), sink_flags(sink_status) {}
+
+    // Both file descriptors are duplicates of the caller's, so O_NONBLOCK
+    // set on them applies to the caller's file descriptors, too. The
+    // flags are restored before the handler is called.
+    void complete(const boost::system::error_code &ec)
+    {
+        ::fcntl(descriptor.native_handle(), F_SETFL, source_flags);
+        ::fcntl(sink, F_SETFL, sink_flags);
+        handler(ec, total);
+    }
+};
+
+template <class Handler>
+void forward_pump(const boost::shared_ptr<forward_op<Handler> > &op);
+
+template <class Handler>
+struct forward_handler
+{
+    boost::shared_ptr<forward_op<Handler> > op_;
+    bool source_;
+
+    forward_handler(const boost::shared_ptr<forward_op<Handler> > &op,
+        bool source) : op_(op), source_(source) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t)
+    {
+        if (ec)
+        {
+            op_->complete(ec);
+            return;
+        }
+        if (source_)
+            op_->source_readable = true;
+        forward_pump(op_);
+    }
+};
+
+template <class Handler>
+void forward_wait_source(const boost::shared_ptr<forward_op<Handler> > &op)
+{
+    op->descriptor.async_read_some(boost::asio::null_buffers(),
+        forward_handler<Handler>(op, true));
+}
+
+template <class Handler>
+void forward_wait_sink(const boost::shared_ptr<forward_op<Handler> > &op)
+{
+    op->sink_descriptor.async_write_some(boost::asio::null_buffers(),
+        forward_handler<Handler>(op, false));
+}
+
+template <class Handler>
+void forward_error(const boost::shared_ptr<forward_op<Handler> > &op)
+{
+    boost::system::error_code ec;
+    BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    op->complete(ec);
+}
+
+// Moves data until either the source is empty or the sink is full and
+// then waits for the respective file descriptor. Both file descriptors
+// are non-blocking, so the I/O service is never blocked. If splice(2)
+// fails with EAGAIN, poll(2) tells whether the sink is full or the
+// source is empty.
+template <class Handler>
+void forward_pump(const boost::shared_ptr<forward_op<Handler> > &op)
+{
+    for (;;)
+    {
+        if (op->begin < op->end)
+        {
+            ssize_t n;
+            do
+            {
+                n = ::write(op->sink, &op->buffer[op->begin],
+                    op->end - op->begin);
+            } while (n == -1 && errno == EINTR);
+            if (n == -1 && errno == EAGAIN)
+                break;
+            if (n == -1)
+            {
+                forward_error(op);
+                return;
+            }
+            op->begin += n;
+            op->total += n;
+            continue;
+        }
+
+#if defined(BOOST_PROCESS_POSIX_HAS_SPLICE)
+        if (op->use_splice)
+        {
+            ssize_t n;
+            do
+            {
+                n = ::splice(op->descriptor.native_handle(), 0, op->sink, 0,
+                    64 * 1024, SPLICE_F_MOVE | SPLICE_F_MORE |
+                    SPLICE_F_NONBLOCK);
+            } while (n == -1 && errno == EINTR);
+            if (n > 0)
+            {
+                op->total += n;
+                continue;
+            }
+            if (n == 0)
+            {
+                op->complete(boost::system::error_code());
+                return;
+            }
+            if (errno == EAGAIN)
+            {
+                if (!sink_writable(op->sink))
+                    break;
+                op->source_readable = false;
+            }
+            else if (errno != EINVAL && errno != ENOSYS)
+            {
+                forward_error(op);
+                return;
+            }
+            else
+            {
+                op->use_splice = false;
+            }
+        }
+#else
+        op->use_splice = false;
+#endif
+
+        if (!op->source_readable)
+        {
+            forward_wait_source(op);
+            return;
+        }
+        op->source_readable = false;
+        ssize_t n;
+        do
+        {
+            n = ::read(op->descriptor.native_handle(), &op->buffer[0],
+                op->buffer.size());
+        } while (n == -1 && errno == EINTR);
+        if (n == 0)
+        {
+            op->complete(boost::system::error_code());
+            return;
+        }
+        if (n == -1 && errno != EAGAIN)
+        {
+            forward_error(op);
+            return;
+        }
+        if (n > 0)
+        {
+            op->begin = 0;
+            op->end = n;
+        }
+    }
+    forward_wait_sink(op);
+}
+
+}
+
+inline std::size_t forward(int source, int sink)
+{
+    std::size_t total = 0;
+    bool use_splice = true;
+    ssize_t n;
+    while ((n = detail::forward_some(source, sink, use_splice)) > 0)
+        total += n;
+    if (n == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("forward() failed");
+    return total;
+}
+
+inline std::size_t forward(int source, int sink, boost::system::error_code &ec)
+{
+    std::size_t total = 0;
+    bool use_splice = true;
+    ssize_t n;
+    while ((n = detail::forward_some(source, sink, use_splice)) > 0)
+        total += n;
+    if (n == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+    return total;
+}
+
+inline std::size_t forward(int source, int sink, int copy)
+{
+    std::size_t total = 0;
+    bool use_tee = true;
+    bool use_splice = true;
+    ssize_t n;
+    while ((n = detail::forward_some(source, sink, copy, use_tee,
+        use_splice)) > 0)
+        total += n;
+    if (n == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("forward() failed");
+    return total;
+}
+
+inline std::size_t forward(int source, int sink, int copy,
+    boost::system::error_code &ec)
+{
+    std::size_t total = 0;
+    bool use_tee = true;
+    bool use_splice = true;
+    ssize_t n;
+    while ((n = detail::forward_some(source, sink, copy, use_tee,
+        use_splice)) > 0)
+        total += n;
+    if (n == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+    return total;
+}
+
+template <class Handler>
+void async_forward(boost::asio::io_service &io_service, int source, int sink,
+    Handler handler)
+{
+    int source_status = ::fcntl(source, F_GETFL);
+    int sink_status = ::fcntl(sink, F_GETFL);
+    int fd = source_status == -1 || sink_status == -1 ? -1 :
+        ::fcntl(source, F_DUPFD_CLOEXEC, 0);
+    int sink_fd = fd == -1 ? -1 : ::fcntl(sink, F_DUPFD_CLOEXEC, 0);
+    if (sink_fd == -1)
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        if (fd != -1)
+            ::close(fd);
+        io_service.post(boost::bind<void>(handler, ec, std::size_t(0)));
+        return;
+    }
+
+    boost::shared_ptr<detail::forward_op<Handler> > op(
+        new detail::forward_op<Handler>(io_service, fd, sink_fd, handler,
+            source_status, sink_status));
+    boost::system::error_code ec;
+    op->descriptor.non_blocking(true, ec);
+    if (!ec)
+        op->sink_descriptor.non_blocking(true, ec);
+    if (ec)
+    {
+        op.reset();
+        ::fcntl(source, F_SETFL, source_status);
+        ::fcntl(sink, F_SETFL, sink_status);
+        io_service.post(boost::bind<void>(handler, ec, std::size_t(0)));
+        return;
+    }
+    detail::forward_wait_source(op);
+}
+
+}}}
+
+#endif
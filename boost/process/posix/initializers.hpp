@@ -10,10 +10,14 @@
 #ifndef BOOST_PROCESS_POSIX_INITIALIZERS_HPP
 #define BOOST_PROCESS_POSIX_INITIALIZERS_HPP
 
+#include <boost/process/posix/initializers/async_on_error.hpp>
 #include <boost/process/posix/initializers/bind_fd.hpp>
 #include <boost/process/posix/initializers/bind_stderr.hpp>
 #include <boost/process/posix/initializers/bind_stdin.hpp>
+#include <boost/process/posix/initializers/bind_stdin_from_memory.hpp>
 #include <boost/process/posix/initializers/bind_stdout.hpp>
+#include <boost/process/posix/initializers/capture_stdout_to_memory.hpp>
+#include <boost/process/posix/initializers/close_all_fds_except.hpp>
 #include <boost/process/posix/initializers/close_fd.hpp>
 #include <boost/process/posix/initializers/close_fds.hpp>
 #include <boost/process/posix/initializers/close_fds_if.hpp>
@@ -22,6 +26,8 @@
 #include <boost/process/posix/initializers/close_stdout.hpp>
 #include <boost/process/posix/initializers/hide_console.hpp>
 #include <boost/process/posix/initializers/inherit_env.hpp>
+#include <boost/process/posix/initializers/new_process_group.hpp>
+#include <boost/process/posix/initializers/new_session.hpp>
 #include <boost/process/posix/initializers/notify_io_service.hpp>
 #include <boost/process/posix/initializers/on_exec_error.hpp>
 #include <boost/process/posix/initializers/on_exec_setup.hpp>
@@ -35,5 +41,6 @@
 #include <boost/process/posix/initializers/set_on_error.hpp>
 #include <boost/process/posix/initializers/start_in_dir.hpp>
 #include <boost/process/posix/initializers/throw_on_error.hpp>
+#include <boost/process/posix/initializers/via.hpp>
 
 #endif
@@ -0,0 +1,199 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_ASYNC_ON_ERROR_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_ASYNC_ON_ERROR_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/create_pipe.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+template <class Handler>
+struct exec_error_op
+{
+    boost::asio::posix::stream_descriptor descriptor;
+    exec_error_message message;
+    Handler handler;
+
+    exec_error_op(boost::asio::io_service &io_service, int fd, Handler h)
+        : descriptor(io_service, fd), handler(h) {}
+};
+
+template <class Handler>
+struct exec_error_handler
+{
+    boost::shared_ptr<exec_error_op<Handler> > op_;
+
+    explicit exec_error_handler(
+        const boost::shared_ptr<exec_error_op<Handler> > &op) : op_(op) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t size)
+    {
+        // The write-end is closed by execve if the program was started.
+        if (size == sizeof(exec_error_message))
+        {
+            op_->handler(boost::system::error_code(op_->message.error,
+                boost::system::system_category()),
+                static_cast<exec_stage>(op_->message.stage));
+        }
+        else if (ec && ec != boost::asio::error::eof)
+        {
+            op_->handler(ec, exec_stage_none);
+        }
+        else
+        {
+            op_->handler(boost::system::error_code(), exec_stage_none);
+        }
+    }
+};
+
+}
+
+namespace initializers {
+
+template <class Handler>
+class async_on_error_ : public initializer_base
+{
+public:
+    async_on_error_(boost::asio::io_service &io_service, Handler handler)
+        : io_service_(io_service), handler_(handler), setup_errno_(0),
+          posted_(false)
+    {
+        fds_[0] = fds_[1] = -1;
+    }
+
+    template <class PosixExecutor>
+    void on_fork_setup(PosixExecutor&) const
+    {
+        posted_ = false;
+        if (detail::create_pipe(fds_, O_CLOEXEC) == -1)
+        {
+            setup_errno_ = errno;
+            fds_[0] = fds_[1] = -1;
+        }
+    }
+
+    template <class PosixExecutor>
+    void on_fork_error(PosixExecutor &e) const
+    {
+        close_fds();
+        post(e.failed_errno, e.failed_stage);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_success(PosixExecutor&) const
+    {
+        // The executor calls on_fork_success after on_fork_error, too.
+        if (posted_)
+            return;
+        if (fds_[0] == -1)
+        {
+            post(setup_errno_, exec_stage_none);
+            return;
+        }
+        ::close(fds_[1]);
+        boost::shared_ptr<detail::exec_error_op<Handler> > op(
+            new detail::exec_error_op<Handler>(io_service_, fds_[0],
+                handler_));
+        fds_[0] = fds_[1] = -1;
+        boost::asio::async_read(op->descriptor,
+            boost::asio::buffer(&op->message, sizeof(op->message)),
+            detail::exec_error_handler<Handler>(op));
+    }
+
+    template <class PosixExecutor>
+    void on_exec_error(PosixExecutor &e) const
+    {
+        if (fds_[1] != -1)
+        {
+            detail::exec_error_message message;
+            message.stage = e.failed_stage;
+            message.error = e.failed_errno;
+            while (::write(fds_[1], &message, sizeof(message)) == -1 &&
+                errno == EINTR)
+                ;
+        }
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_error(PosixExecutor &e) const
+    {
+        post(e.failed_errno, e.failed_stage);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_success(PosixExecutor&) const
+    {
+        post(0, exec_stage_none);
+    }
+
+private:
+    void close_fds() const
+    {
+        if (fds_[0] != -1)
+        {
+            ::close(fds_[0]);
+            ::close(fds_[1]);
+            fds_[0] = fds_[1] = -1;
+        }
+    }
+
+    void post(int error, exec_stage stage) const
+    {
+        posted_ = true;
+        io_service_.post(boost::bind<void>(handler_,
+            boost::system::error_code(error,
+                boost::system::system_category()), stage));
+    }
+
+    boost::asio::io_service &io_service_;
+    Handler handler_;
+    mutable int fds_[2];
+    mutable int setup_errno_;
+    mutable bool posted_;
+};
+
+template <class Handler>
+struct is_spawnable<async_on_error_<Handler> > : boost::true_type {};
+
+template <class Handler>
+struct is_vfork_safe<async_on_error_<Handler> > : boost::true_type {};
+
+template <class Handler>
+struct is_fork_server_compatible<async_on_error_<Handler> >
+    : boost::true_type {};
+
+template <class Handler>
+async_on_error_<Handler> async_on_error(boost::asio::io_service &io_service,
+    Handler handler)
+{
+    return async_on_error_<Handler>(io_service, handler);
+}
+
+}
+
+}}}
+
+#endif
@@ -11,7 +11,10 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_BIND_FD_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <unistd.h>
+#include <spawn.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -22,9 +25,22 @@ public:
     bind_fd_(int id, const FileDescriptor &fd) : id_(id), fd_(fd) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        ::dup2(fd_.handle(), id_);
+        if (detail::dup_fd(fd_.handle(), id_) == -1)
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_adddup2(e.file_actions, fd_.handle(), id_);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->bind(fd_.handle(), id_);
     }
 
 private:
@@ -32,6 +48,16 @@ private:
     FileDescriptor fd_;
 };
 
+template <class FileDescriptor>
+struct is_spawnable<bind_fd_<FileDescriptor> > : boost::true_type {};
+
+template <class FileDescriptor>
+struct is_vfork_safe<bind_fd_<FileDescriptor> > : boost::true_type {};
+
+template <class FileDescriptor>
+struct is_fork_server_compatible<bind_fd_<FileDescriptor> >
+    : boost::true_type {};
+
 template <class FileDescriptor>
 bind_fd_<FileDescriptor> bind_fd(int id, const FileDescriptor &fd)
 {
@@ -11,8 +11,11 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_BIND_STDERR_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <unistd.h>
+#include <spawn.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -23,15 +26,41 @@ public:
         : sink_(sink) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        ::dup2(sink_.handle(), STDERR_FILENO);
+        if (detail::dup_fd(sink_.handle(), STDERR_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_adddup2(e.file_actions, sink_.handle(),
+            STDERR_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->bind(sink_.handle(), STDERR_FILENO);
     }
 
 private:
     boost::iostreams::file_descriptor_sink sink_;
 };
 
+template <>
+struct is_spawnable<bind_stderr> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<bind_stderr> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<bind_stderr> : boost::true_type {};
+
+template <>
+struct binds_stderr<bind_stderr> : boost::true_type {};
+
 }}}}
 
 #endif
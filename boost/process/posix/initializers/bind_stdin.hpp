@@ -11,8 +11,11 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_BIND_STDIN_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <unistd.h>
+#include <spawn.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -23,15 +26,38 @@ public:
         : source_(source) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        ::dup2(source_.handle(), STDIN_FILENO);
+        if (detail::dup_fd(source_.handle(), STDIN_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_adddup2(e.file_actions, source_.handle(),
+            STDIN_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->bind(source_.handle(), STDIN_FILENO);
     }
 
 private:
     boost::iostreams::file_descriptor_source source_;
 };
 
+template <>
+struct is_spawnable<bind_stdin> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<bind_stdin> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<bind_stdin> : boost::true_type {};
+
 }}}}
 
 #endif
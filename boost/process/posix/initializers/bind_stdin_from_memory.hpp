@@ -0,0 +1,186 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_BIND_STDIN_FROM_MEMORY_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_BIND_STDIN_FROM_MEMORY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/detail/memfd.hpp>
+#include <boost/process/posix/detail/write_all.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <unistd.h>
+#include <spawn.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+class bind_stdin_from_memory : public initializer_base
+{
+public:
+    explicit bind_stdin_from_memory(const boost::asio::const_buffer &buffer)
+        : fd_(-1)
+    {
+        if (!create(buffer, -1))
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR(
+                "bind_stdin_from_memory() failed");
+    }
+
+    bind_stdin_from_memory(const boost::asio::const_buffer &buffer,
+        boost::system::error_code &ec)
+        : fd_(-1)
+    {
+        if (create(buffer, -1))
+            ec.clear();
+        else
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    }
+
+    explicit bind_stdin_from_memory(
+        const boost::iostreams::file_descriptor_source &source)
+        : fd_(-1)
+    {
+        if (!create(boost::asio::const_buffer(), source.handle()))
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR(
+                "bind_stdin_from_memory() failed");
+    }
+
+    bind_stdin_from_memory(
+        const boost::iostreams::file_descriptor_source &source,
+        boost::system::error_code &ec)
+        : fd_(-1)
+    {
+        if (create(boost::asio::const_buffer(), source.handle()))
+            ec.clear();
+        else
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_setup(PosixExecutor&) const
+    {
+        reopen();
+    }
+
+    template <class PosixExecutor>
+    void on_fork_success(PosixExecutor&) const
+    {
+        close_reopened();
+    }
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (detail::dup_fd(source(), STDIN_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        reopen();
+        ::posix_spawn_file_actions_adddup2(e.file_actions, source(),
+            STDIN_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_error(PosixExecutor&) const
+    {
+        close_reopened();
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_success(PosixExecutor&) const
+    {
+        close_reopened();
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        reopen();
+        e.request->bind(source(), STDIN_FILENO);
+    }
+
+private:
+    // The data is written to a memfd which is sealed afterwards, so the
+    // child process can neither modify it nor change its size. If the
+    // memfd can't be created, file_ stays closed and dup2() reports EBADF
+    // in the child process.
+    bool create(const boost::asio::const_buffer &buffer, int source)
+    {
+        int fd = detail::create_memfd("boost_process_stdin");
+        if (fd == -1)
+            return false;
+        bool ok = source == -1 ?
+            detail::write_all(fd,
+                boost::asio::buffer_cast<const char*>(buffer),
+                boost::asio::buffer_size(buffer)) :
+            detail::copy_fd(source, fd);
+        // The offset is reset for the fallback in source(), which binds
+        // file_ itself if it can't be opened again.
+        if (!ok || detail::seal_memfd(fd) == -1 ||
+            ::lseek(fd, 0, SEEK_SET) == -1)
+        {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return false;
+        }
+        file_ = boost::iostreams::file_descriptor_source(fd,
+            boost::iostreams::close_handle);
+        return true;
+    }
+
+    // Every child process gets its own file description, so it reads
+    // from the start of the file no matter what other child processes
+    // started with the same initializer do with their offsets. The file
+    // descriptor is closed in the parent process once the child process
+    // has been started. Without /proc all child processes share the file
+    // description of file_.
+    void reopen() const
+    {
+        fd_ = file_.handle() == -1 ? -1 : detail::reopen_fd(file_.handle());
+    }
+
+    int source() const
+    {
+        return fd_ != -1 ? fd_ : file_.handle();
+    }
+
+    void close_reopened() const
+    {
+        if (fd_ != -1)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    boost::iostreams::file_descriptor_source file_;
+    mutable int fd_;
+};
+
+template <>
+struct is_spawnable<bind_stdin_from_memory> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<bind_stdin_from_memory> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<bind_stdin_from_memory> : boost::true_type {};
+
+}}}}
+
+#endif
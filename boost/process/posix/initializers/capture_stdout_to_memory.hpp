@@ -0,0 +1,167 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_CAPTURE_STDOUT_TO_MEMORY_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_CAPTURE_STDOUT_TO_MEMORY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/detail/memfd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+// A file in memory the child process writes to and a read-only mapping
+// of its contents in the parent process. The mapping is replaced if the
+// file has grown since it was mapped.
+class memory_capture : boost::noncopyable
+{
+public:
+    memory_capture() : fd_(create_memfd("boost_process_capture")), data_(0),
+        size_(0) {}
+
+    ~memory_capture()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+        if (fd_ != -1)
+            ::close(fd_);
+    }
+
+    int fd() const { return fd_; }
+
+    bool map()
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) == -1)
+            return false;
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        if (size == size_)
+            return true;
+        if (data_)
+            ::munmap(data_, size_);
+        data_ = 0;
+        size_ = 0;
+        if (size == 0)
+            return true;
+        void *data = ::mmap(0, size, PROT_READ, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED)
+            return false;
+        data_ = data;
+        size_ = size;
+        return true;
+    }
+
+    boost::asio::const_buffer buffer() const
+    {
+        return boost::asio::const_buffer(data_, size_);
+    }
+
+private:
+    int fd_;
+    void *data_;
+    std::size_t size_;
+};
+
+}
+
+namespace initializers {
+
+class capture_stdout_to_memory : public initializer_base
+{
+public:
+    capture_stdout_to_memory() : capture_(new detail::memory_capture())
+    {
+        if (capture_->fd() == -1)
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR(
+                "capture_stdout_to_memory() failed");
+    }
+
+    explicit capture_stdout_to_memory(boost::system::error_code &ec)
+        : capture_(new detail::memory_capture())
+    {
+        if (capture_->fd() == -1)
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        else
+            ec.clear();
+    }
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (detail::dup_fd(capture_->fd(), STDOUT_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_adddup2(e.file_actions, capture_->fd(),
+            STDOUT_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->bind(capture_->fd(), STDOUT_FILENO);
+    }
+
+    boost::asio::const_buffer buffer() const
+    {
+        if (!capture_->map())
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("buffer() failed");
+        return capture_->buffer();
+    }
+
+    boost::asio::const_buffer buffer(boost::system::error_code &ec) const
+    {
+        if (!capture_->map())
+        {
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            return boost::asio::const_buffer();
+        }
+        ec.clear();
+        return capture_->buffer();
+    }
+
+private:
+    boost::shared_ptr<detail::memory_capture> capture_;
+};
+
+template <>
+struct is_spawnable<capture_stdout_to_memory> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<capture_stdout_to_memory> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<capture_stdout_to_memory> :
+    boost::true_type {};
+
+template <>
+struct binds_stdout<capture_stdout_to_memory> : boost::true_type {};
+
+}}}}
+
+#endif
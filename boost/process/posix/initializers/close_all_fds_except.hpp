@@ -0,0 +1,147 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_ALL_FDS_EXCEPT_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_ALL_FDS_EXCEPT_HPP
+
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/close_fd.hpp>
+#include <boost/process/posix/detail/open_fds.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/range/begin.hpp>
+#include <boost/range/end.hpp>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+class close_all_fds_except_ : public initializer_base
+{
+private:
+    struct close_unless
+    {
+        const std::vector<int> &fds_;
+        int &error_;
+
+        close_unless(const std::vector<int> &fds, int &error)
+            : fds_(fds), error_(error) {}
+
+        void operator()(int fd) const
+        {
+            if (!std::binary_search(fds_.begin(), fds_.end(), fd) &&
+                detail::set_cloexec(fd) == -1 && !error_)
+                error_ = errno;
+        }
+    };
+
+    template <class PosixExecutor>
+    struct add_close_unless
+    {
+        const std::vector<int> &fds_;
+        PosixExecutor &e_;
+
+        add_close_unless(const std::vector<int> &fds, PosixExecutor &e)
+            : fds_(fds), e_(e) {}
+
+        void operator()(int fd) const
+        {
+            if (!std::binary_search(fds_.begin(), fds_.end(), fd) &&
+                ::fcntl(fd, F_GETFD) != -1)
+                e_.spawn_close(fd);
+        }
+    };
+
+    struct is_excluded
+    {
+        const std::vector<int> &fds_;
+
+        is_excluded(const std::vector<int> &fds) : fds_(fds) {}
+
+        bool operator()(int fd) const
+        {
+            return !std::binary_search(fds_.begin(), fds_.end(), fd);
+        }
+    };
+
+public:
+    template <class Range>
+    explicit close_all_fds_except_(const Range &fds)
+        : fds_(boost::begin(fds), boost::end(fds))
+    {
+        std::sort(fds_.begin(), fds_.end());
+        fds_.erase(std::unique(fds_.begin(), fds_.end()), fds_.end());
+        fds_.erase(fds_.begin(),
+            std::lower_bound(fds_.begin(), fds_.end(), 0));
+    }
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (cloexec_gaps())
+            return;
+        int error = 0;
+        detail::open_fds::for_each(close_unless(fds_, error));
+        if (error)
+        {
+            errno = error;
+            e.exec_failed(exec_stage_close);
+        }
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        detail::open_fds::for_each(
+            add_close_unless<PosixExecutor>(fds_, e));
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->close_if(is_excluded(fds_));
+    }
+
+private:
+    bool cloexec_gaps() const
+    {
+        unsigned int first = 0;
+        for (std::vector<int>::const_iterator it = fds_.begin();
+            it != fds_.end(); ++it)
+        {
+            unsigned int fd = static_cast<unsigned int>(*it);
+            if (fd > first && !detail::cloexec_range(first, fd - 1))
+                return false;
+            first = fd + 1;
+        }
+        return detail::cloexec_range(first, ~0U);
+    }
+
+    std::vector<int> fds_;
+};
+
+template <>
+struct is_spawnable<close_all_fds_except_> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<close_all_fds_except_> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<close_all_fds_except_> : boost::true_type {};
+
+template <class Range>
+close_all_fds_except_ close_all_fds_except(const Range &fds)
+{
+    return close_all_fds_except_(fds);
+}
+
+}}}}
+
+#endif
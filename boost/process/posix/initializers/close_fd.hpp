@@ -11,7 +11,10 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_FD_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/close_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <unistd.h>
+#include <spawn.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -21,15 +24,37 @@ public:
     explicit close_fd(int fd) : fd_(fd) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        ::close(fd_);
+        if (detail::close_fd(fd_) == -1)
+            e.exec_failed(exec_stage_close);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_addclose(e.file_actions, fd_);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->close(fd_);
     }
 
 private:
     int fd_;
 };
 
+template <>
+struct is_spawnable<close_fd> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<close_fd> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<close_fd> : boost::true_type {};
+
 }}}}
 
 #endif
@@ -11,7 +11,11 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_FDS_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
-#include <boost/range/algorithm/for_each.hpp>
+#include <boost/process/posix/detail/close_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/range/begin.hpp>
+#include <boost/range/end.hpp>
+#include <boost/range/iterator.hpp>
 #include <unistd.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
@@ -23,15 +27,45 @@ public:
     explicit close_fds_(const Range &fds) : fds_(fds) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        boost::for_each(fds_, ::close);
+        typedef typename boost::range_iterator<const Range>::type iterator;
+        for (iterator it = boost::begin(fds_); it != boost::end(fds_); ++it)
+        {
+            if (detail::close_fd(*it) == -1)
+                e.exec_failed(exec_stage_close);
+        }
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        typedef typename boost::range_iterator<const Range>::type iterator;
+        for (iterator it = boost::begin(fds_); it != boost::end(fds_); ++it)
+            e.spawn_close(*it);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        typedef typename boost::range_iterator<const Range>::type iterator;
+        for (iterator it = boost::begin(fds_); it != boost::end(fds_); ++it)
+            e.request->close(*it);
     }
 
 private:
     Range fds_;
 };
 
+template <class Range>
+struct is_spawnable<close_fds_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_vfork_safe<close_fds_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_fork_server_compatible<close_fds_<Range> > : boost::true_type {};
+
 template <class Range>
 close_fds_<Range> close_fds(const Range &fds)
 {
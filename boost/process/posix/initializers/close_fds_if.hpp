@@ -11,17 +11,11 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_FDS_IF_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
-#include <boost/iterator/counting_iterator.hpp>
-#include <boost/range/counting_range.hpp>
-#include <boost/range/adaptor/filtered.hpp>
-#include <boost/range/algorithm/for_each.hpp>
+#include <boost/process/posix/detail/close_fd.hpp>
+#include <boost/process/posix/detail/open_fds.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <unistd.h>
 #include <fcntl.h>
-#include <errno.h>
-
-#ifndef BOOST_PROCESS_POSIX_MAX_FD
-#   define BOOST_PROCESS_POSIX_MAX_FD 32
-#endif
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -29,46 +23,79 @@ template <class Predicate>
 class close_fds_if_ : public initializer_base
 {
 private:
-    static void close(int fd)
+    struct close_if
     {
-        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
-    }
+        const Predicate &pred_;
+        int &error_;
+
+        close_if(const Predicate &pred, int &error)
+            : pred_(pred), error_(error) {}
+
+        void operator()(int fd) const
+        {
+            if (pred_(fd) && detail::set_cloexec(fd) == -1 && !error_)
+                error_ = errno;
+        }
+    };
+
+    template <class PosixExecutor>
+    struct add_close_if
+    {
+        const Predicate &pred_;
+        PosixExecutor &e_;
+
+        add_close_if(const Predicate &pred, PosixExecutor &e)
+            : pred_(pred), e_(e) {}
+
+        void operator()(int fd) const
+        {
+            if (pred_(fd) && ::fcntl(fd, F_GETFD) != -1)
+                e_.spawn_close(fd);
+        }
+    };
 
 public:
     explicit close_fds_if_(const Predicate &pred) : pred_(pred) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        boost::for_each(
-            boost::adaptors::filter(
-                boost::counting_range(0, upper_bound()),
-                pred_
-            ),
-            close
-        );
+        int error = 0;
+        detail::open_fds::for_each(close_if(pred_, error));
+        if (error)
+        {
+            errno = error;
+            e.exec_failed(exec_stage_close);
+        }
     }
 
-private:
-    static int upper_bound()
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
     {
-        int up;
-#if defined(F_MAXFD)
-        do
-        {
-            up = ::fcntl(0, F_MAXFD);
-        } while (up == -1 && errno == EINTR);
-        if (up == -1)
-#endif
-            up = ::sysconf(_SC_OPEN_MAX);
-        if (up == -1)
-            up = BOOST_PROCESS_POSIX_MAX_FD;
-        return up;
+        detail::open_fds::for_each(
+            add_close_if<PosixExecutor>(pred_, e));
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->close_if(pred_);
     }
 
+private:
     Predicate pred_;
 };
 
+template <class Predicate>
+struct is_spawnable<close_fds_if_<Predicate> > : boost::true_type {};
+
+template <class Predicate>
+struct is_vfork_safe<close_fds_if_<Predicate> > : is_vfork_safe<Predicate> {};
+
+template <class Predicate>
+struct is_fork_server_compatible<close_fds_if_<Predicate> >
+    : boost::true_type {};
+
 template <class Predicate>
 close_fds_if_<Predicate> close_fds_if(const Predicate &pred)
 {
@@ -11,7 +11,10 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_CLOSE_STDERR_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/detail/close_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <unistd.h>
+#include <spawn.h>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -19,12 +22,37 @@ class close_stderr : public initializer_base
 {
 public:
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
     {
-        ::close(STDERR_FILENO);
+        if (detail::close_fd(STDERR_FILENO) == -1)
+            e.exec_failed(exec_stage_close);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        ::posix_spawn_file_actions_addclose(e.file_actions, STDERR_FILENO);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->close(STDERR_FILENO);
     }
 };
 
+template <>
+struct is_spawnable<close_stderr> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<close_stderr> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<close_stderr> : boost::true_type {};
+
+template <>
+struct binds_stderr<close_stderr> : boost::true_type {};
+
 }}}}
 
 #endif
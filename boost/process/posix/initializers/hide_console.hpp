@@ -19,6 +19,15 @@ class hide_console : public initializer_base
 public:
 };
 
+template <>
+struct is_spawnable<hide_console> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<hide_console> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<hide_console> : boost::true_type {};
+
 }}}}
 
 #endif
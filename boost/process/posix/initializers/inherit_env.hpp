@@ -29,8 +29,29 @@ public:
     {
         e.env = environ;
     }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        e.env = environ;
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.env = environ;
+    }
 };
 
+template <>
+struct is_spawnable<inherit_env> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<inherit_env> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<inherit_env> : boost::true_type {};
+
 }}}}
 
 #endif
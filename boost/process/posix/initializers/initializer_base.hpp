@@ -10,6 +10,8 @@
 #ifndef BOOST_PROCESS_POSIX_INITIALIZERS_INITIALIZER_BASE_HPP
 #define BOOST_PROCESS_POSIX_INITIALIZERS_INITIALIZER_BASE_HPP
 
+#include <boost/type_traits/integral_constant.hpp>
+
 namespace boost { namespace process { namespace posix { namespace initializers {
 
 struct initializer_base
@@ -28,8 +30,39 @@ struct initializer_base
 
     template <class PosixExecutor>
     void on_exec_error(PosixExecutor&) const {}
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor&) const {}
+
+    template <class PosixExecutor>
+    void on_spawn_error(PosixExecutor&) const {}
+
+    template <class PosixExecutor>
+    void on_spawn_success(PosixExecutor&) const {}
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor&) const {}
 };
 
+template <class Initializer>
+struct is_spawnable : boost::false_type {};
+
+template <class Initializer>
+struct is_vfork_safe : boost::false_type {};
+
+template <class Initializer>
+struct is_fork_server_compatible : boost::false_type {};
+
+template <class Initializer>
+struct uses_fork_server : boost::false_type {};
+
+// Set for initializers which bind or close stdout respectively stderr.
+template <class Initializer>
+struct binds_stdout : boost::false_type {};
+
+template <class Initializer>
+struct binds_stderr : boost::false_type {};
+
 }}}}
 
 #endif
@@ -0,0 +1,60 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_NEW_SESSION_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_NEW_SESSION_HPP
+
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <unistd.h>
+#include <spawn.h>
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+class new_session : public initializer_base
+{
+public:
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (::setsid() == -1)
+            e.exec_failed(exec_stage_setsid);
+    }
+
+#if defined(POSIX_SPAWN_SETSID)
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        short flags;
+        ::posix_spawnattr_getflags(e.attr, &flags);
+        ::posix_spawnattr_setflags(e.attr, flags | POSIX_SPAWN_SETSID);
+    }
+#endif
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->flags |= e.request->new_session;
+    }
+};
+
+#if defined(POSIX_SPAWN_SETSID)
+template <>
+struct is_spawnable<new_session> : boost::true_type {};
+#endif
+
+template <>
+struct is_vfork_safe<new_session> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<new_session> : boost::true_type {};
+
+}}}}
+
+#endif
@@ -44,6 +44,13 @@ private:
     IOService &io_service_;
 };
 
+template <class IOService>
+struct is_spawnable<notify_io_service_<IOService> > : boost::true_type {};
+
+template <class IOService>
+struct is_fork_server_compatible<notify_io_service_<IOService> >
+    : boost::true_type {};
+
 template <class IOService>
 notify_io_service_<IOService> notify_io_service(IOService &io_service)
 {
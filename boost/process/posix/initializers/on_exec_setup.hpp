@@ -31,6 +31,9 @@ private:
     Handler handler_;
 };
 
+template <class Handler>
+struct is_vfork_safe<on_exec_setup_<Handler> > : is_vfork_safe<Handler> {};
+
 template <class Handler>
 on_exec_setup_<Handler> on_exec_setup(Handler handler)
 {
@@ -31,6 +31,9 @@ private:
     Handler handler_;
 };
 
+template <class Handler>
+struct is_vfork_safe<on_fork_error_<Handler> > : boost::true_type {};
+
 template <class Handler>
 on_fork_error_<Handler> on_fork_error(Handler handler)
 {
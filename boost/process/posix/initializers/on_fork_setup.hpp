@@ -31,6 +31,9 @@ private:
     Handler handler_;
 };
 
+template <class Handler>
+struct is_vfork_safe<on_fork_setup_<Handler> > : boost::true_type {};
+
 template <class Handler>
 on_fork_setup_<Handler> on_fork_setup(Handler handler)
 {
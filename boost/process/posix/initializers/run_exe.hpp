@@ -20,10 +20,22 @@ namespace boost { namespace process { namespace posix { namespace initializers {
 class run_exe_ : public initializer_base
 {
 public:
-    explicit run_exe_(const std::string &s) : s_(s), cmd_line_(new char*[2])
+    explicit run_exe_(const std::string &s) : s_(s)
     {
-        cmd_line_[0] = const_cast<char*>(s_.c_str());
-        cmd_line_[1] = 0;
+        init();
+    }
+
+    // cmd_line_ points into s_ and must be rebuilt for every copy.
+    run_exe_(const run_exe_ &other) : s_(other.s_)
+    {
+        init();
+    }
+
+    run_exe_ &operator=(const run_exe_ &other)
+    {
+        s_ = other.s_;
+        init();
+        return *this;
     }
 
     template <class PosixExecutor>
@@ -34,11 +46,39 @@ public:
             e.cmd_line = cmd_line_.get();
     }
 
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
 private:
+    void init()
+    {
+        cmd_line_.reset(new char*[2]);
+        cmd_line_[0] = const_cast<char*>(s_.c_str());
+        cmd_line_[1] = 0;
+    }
+
     std::string s_;
     boost::shared_array<char*> cmd_line_;
 };
 
+template <>
+struct is_spawnable<run_exe_> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<run_exe_> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<run_exe_> : boost::true_type {};
+
 inline run_exe_ run_exe(const char *s)
 {
     return run_exe_(s);
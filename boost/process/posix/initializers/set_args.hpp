@@ -11,6 +11,7 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_SET_ARGS_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/argv_builder.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/shared_array.hpp>
 #include <string>
@@ -42,10 +43,63 @@ public:
             e.exe = args_[0];
     }
 
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
 private:
     boost::shared_array<char*> args_;
 };
 
+// An argv_builder already holds the argument vector. It is used as is
+// and must be valid until execute returns.
+template <>
+class set_args_<argv_builder> : public initializer_base
+{
+public:
+    explicit set_args_(const argv_builder &args) : args_(&args) {}
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        e.cmd_line = args_->argv();
+        if (!e.exe && !args_->empty() && *(*args_)[0])
+            e.exe = (*args_)[0];
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        on_exec_setup(e);
+    }
+
+private:
+    const argv_builder *args_;
+};
+
+template <class Range>
+struct is_spawnable<set_args_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_vfork_safe<set_args_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_fork_server_compatible<set_args_<Range> > : boost::true_type {};
+
 template <class Range>
 set_args_<Range> set_args(const Range &range)
 {
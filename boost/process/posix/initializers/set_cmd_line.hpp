@@ -11,44 +11,55 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_SET_CMD_LINE_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/argv_builder.hpp>
 #include <boost/tokenizer.hpp>
-#include <boost/shared_array.hpp>
 #include <string>
-#include <vector>
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
 class set_cmd_line : public initializer_base
 {
-private:
-    static char *c_str(const std::string &s)
-    {
-        return const_cast<char*>(s.c_str());
-    }
-
 public:
     explicit set_cmd_line(const std::string &s)
     {
         typedef boost::tokenizer<boost::escaped_list_separator<char> > tokenizer;
         boost::escaped_list_separator<char> sep('\\', ' ', '\"');
         tokenizer tok(s, sep);
-        args_.assign(tok.begin(), tok.end());
-        cmd_line_.reset(new char*[args_.size() + 1]);
-        boost::transform(args_, cmd_line_.get(), c_str);
-        cmd_line_[args_.size()] = 0;
+        for (tokenizer::iterator it = tok.begin(); it != tok.end(); ++it)
+            args_.arg(*it);
     }
 
     template <class PosixExecutor>
     void on_exec_setup(PosixExecutor &e) const
     {
-        e.cmd_line = cmd_line_.get();
+        e.cmd_line = args_.argv();
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        e.cmd_line = args_.argv();
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.cmd_line = args_.argv();
     }
 
 private:
-    std::vector<std::string> args_;
-    boost::shared_array<char*> cmd_line_;
+    argv_builder args_;
 };
 
+template <>
+struct is_spawnable<set_cmd_line> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<set_cmd_line> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<set_cmd_line> : boost::true_type {};
+
 }}}}
 
 #endif
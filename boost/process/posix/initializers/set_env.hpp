@@ -11,6 +11,7 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_SET_ENV_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/environment.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/shared_array.hpp>
 #include <string>
@@ -39,10 +40,61 @@ public:
         e.env = env_.get();
     }
 
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        e.env = env_.get();
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.env = env_.get();
+    }
+
 private:
     boost::shared_array<char*> env_;
 };
 
+// The environment block is built when the initializer is constructed.
+// The environment must not be changed until execute returns.
+template <>
+class set_env_<environment> : public initializer_base
+{
+public:
+    explicit set_env_(const environment &env) : env_(env.envp()) {}
+
+    template <class PosixExecutor>
+    void on_fork_setup(PosixExecutor &e) const
+    {
+        e.env = env_;
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        e.env = env_;
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.env = env_;
+    }
+
+private:
+    char **env_;
+};
+
+template <class Range>
+struct is_spawnable<set_env_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_vfork_safe<set_env_<Range> > : boost::true_type {};
+
+template <class Range>
+struct is_fork_server_compatible<set_env_<Range> > : boost::true_type {};
+
 template <class Range>
 set_env_<Range> set_env(const Range &envs)
 {
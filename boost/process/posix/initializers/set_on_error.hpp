@@ -12,6 +12,8 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/create_pipe.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <boost/system/error_code.hpp>
 #include <unistd.h>
 #include <fcntl.h>
@@ -22,19 +24,20 @@ namespace boost { namespace process { namespace posix { namespace initializers {
 class set_on_error : public initializer_base
 {
 public:
-    explicit set_on_error(boost::system::error_code &ec) : ec_(ec) {}
+    explicit set_on_error(boost::system::error_code &ec)
+        : ec_(ec), stage_(0) {}
+
+    set_on_error(boost::system::error_code &ec, exec_stage &stage)
+        : ec_(ec), stage_(&stage) {}
 
     template <class PosixExecutor>
     void on_fork_setup(PosixExecutor&) const
     {
-        if (::pipe(fds_) == -1)
-            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec_);
-        if (::fcntl(fds_[1], F_SETFD, FD_CLOEXEC) == -1)
-        {
+        set_stage(exec_stage_none);
+        // Both ends are closed by execve(). The child process doesn't
+        // need to close the read-end.
+        if (detail::create_pipe(fds_, O_CLOEXEC) == -1)
             BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec_);
-            ::close(fds_[0]);
-            ::close(fds_[1]);
-        }
     }
 
     template <class PosixExecutor>
@@ -43,6 +46,7 @@ public:
         if (!ec_)
         {
             BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec_);
+            set_stage(exec_stage_fork);
             ::close(fds_[0]);
             ::close(fds_[1]);
         }
@@ -54,42 +58,77 @@ public:
         if (!ec_)
         {
             ::close(fds_[1]);
-            int code;
-            if (::read(fds_[0], &code, sizeof(int)) > 0)
+            detail::exec_error_message message;
+            ssize_t n;
+            do
+            {
+                n = ::read(fds_[0], &message, sizeof(message));
+            } while (n == -1 && errno == EINTR);
+            if (n == sizeof(message))
             {
-                ec_ = boost::system::error_code(code,
+                ec_ = boost::system::error_code(message.error,
                     boost::system::system_category());
+                set_stage(static_cast<exec_stage>(message.stage));
             }
             ::close(fds_[0]);
         }
     }
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_spawn_setup(PosixExecutor&) const
     {
-        if (!ec_)
-        {
-            ::close(fds_[0]);
-        }
+        set_stage(exec_stage_none);
     }
 
     template <class PosixExecutor>
-    void on_exec_error(PosixExecutor&) const
+    void on_spawn_error(PosixExecutor &e) const
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec_);
+        set_stage(e.failed_stage);
+    }
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor&) const
+    {
+        set_stage(exec_stage_none);
+    }
+
+    template <class PosixExecutor>
+    void on_exec_error(PosixExecutor &e) const
     {
         if (!ec_)
         {
-            int e = errno;
-            while (::write(fds_[1], &e, sizeof(int)) == -1 && errno == EINTR)
+            detail::exec_error_message message;
+            message.stage = e.failed_stage;
+            message.error = e.failed_errno;
+            while (::write(fds_[1], &message, sizeof(message)) == -1 &&
+                errno == EINTR)
                 ;
             ::close(fds_[1]);
         }
     }
 
 private:
+    void set_stage(exec_stage stage) const
+    {
+        if (stage_)
+            *stage_ = stage;
+    }
+
     boost::system::error_code &ec_;
+    exec_stage *stage_;
     mutable int fds_[2];
 };
 
+template <>
+struct is_spawnable<set_on_error> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<set_on_error> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<set_on_error> : boost::true_type {};
+
 }}}}
 
 #endif
@@ -11,8 +11,15 @@
 #define BOOST_PROCESS_POSIX_INITIALIZERS_START_IN_DIR_HPP
 
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <string>
 #include <unistd.h>
+#include <spawn.h>
+
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#   define BOOST_PROCESS_POSIX_HAS_SPAWN_ADDCHDIR
+#endif
 
 namespace boost { namespace process { namespace posix { namespace initializers {
 
@@ -22,15 +29,41 @@ public:
     explicit start_in_dir(const std::string &s) : s_(s) {}
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (::chdir(s_.c_str()) == -1)
+            e.exec_failed(exec_stage_chdir);
+    }
+
+#if defined(BOOST_PROCESS_POSIX_HAS_SPAWN_ADDCHDIR)
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
     {
-        ::chdir(s_.c_str());
+        ::posix_spawn_file_actions_addchdir_np(e.file_actions, s_.c_str());
+    }
+#endif
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->work_dir = s_.c_str();
     }
 
 private:
     std::string s_;
 };
 
+#if defined(BOOST_PROCESS_POSIX_HAS_SPAWN_ADDCHDIR)
+template <>
+struct is_spawnable<start_in_dir> : boost::true_type {};
+#endif
+
+template <>
+struct is_vfork_safe<start_in_dir> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<start_in_dir> : boost::true_type {};
+
 }}}}
 
 #endif
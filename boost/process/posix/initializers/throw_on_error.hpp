@@ -12,8 +12,11 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/create_pipe.hpp>
+#include <boost/process/posix/exec_stage.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/system/system_error.hpp>
+#include <string>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -26,17 +29,10 @@ public:
     template <class PosixExecutor>
     void on_fork_setup(PosixExecutor&) const
     {
-        if (::pipe(fds_) == -1)
-            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("pipe(2) failed");
-        if (::fcntl(fds_[1], F_SETFD, FD_CLOEXEC) == -1)
-        {
-            int e = errno;
-            ::close(fds_[0]);
-            ::close(fds_[1]);
-            BOOST_PROCESS_THROW(boost::system::system_error(
-                boost::system::error_code(e, boost::system::system_category()),
-                BOOST_PROCESS_SOURCE_LOCATION "fcntl(2) failed"));
-        }
+        // Both ends are closed by execve(). The child process doesn't
+        // need to close the read-end.
+        if (detail::create_pipe(fds_, O_CLOEXEC) == -1)
+            BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("pipe2(2) failed");
     }
 
     template <class PosixExecutor>
@@ -54,37 +50,58 @@ public:
     void on_fork_success(PosixExecutor&) const
     {
         ::close(fds_[1]);
-        int code;
-        if (::read(fds_[0], &code, sizeof(int)) > 0)
+        detail::exec_error_message message;
+        ssize_t n;
+        do
         {
-            ::close(fds_[0]);
-            BOOST_PROCESS_THROW(boost::system::system_error(
-                boost::system::error_code(code,
-                boost::system::system_category()),
-                BOOST_PROCESS_SOURCE_LOCATION "execve(2) failed"));
-        }
+            n = ::read(fds_[0], &message, sizeof(message));
+        } while (n == -1 && errno == EINTR);
         ::close(fds_[0]);
+        if (n == sizeof(message))
+            throw_error(message.error,
+                static_cast<exec_stage>(message.stage));
     }
 
     template <class PosixExecutor>
-    void on_exec_setup(PosixExecutor&) const
+    void on_spawn_error(PosixExecutor &e) const
     {
-        ::close(fds_[0]);
+        throw_error(e.failed_errno, e.failed_stage);
     }
 
     template <class PosixExecutor>
-    void on_exec_error(PosixExecutor&) const
+    void on_exec_error(PosixExecutor &e) const
     {
-        int e = errno;
-        while (::write(fds_[1], &e, sizeof(int)) == -1 && errno == EINTR)
+        detail::exec_error_message message;
+        message.stage = e.failed_stage;
+        message.error = e.failed_errno;
+        while (::write(fds_[1], &message, sizeof(message)) == -1 &&
+            errno == EINTR)
             ;
         ::close(fds_[1]);
     }
 
 private:
+    static void throw_error(int error, exec_stage stage)
+    {
+        BOOST_PROCESS_THROW(boost::system::system_error(
+            boost::system::error_code(error,
+            boost::system::system_category()),
+            std::string(BOOST_PROCESS_SOURCE_LOCATION) +
+            detail::exec_stage_what(stage)));
+    }
+
     mutable int fds_[2];
 };
 
+template <>
+struct is_spawnable<throw_on_error> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<throw_on_error> : boost::true_type {};
+
+template <>
+struct is_fork_server_compatible<throw_on_error> : boost::true_type {};
+
 }}}}
 
 #endif
@@ -0,0 +1,50 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZERS_VIA_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZERS_VIA_HPP
+
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/process/posix/fork_server.hpp>
+
+#if defined(BOOST_PROCESS_POSIX_HAS_FORK_SERVER)
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+class via_ : public initializer_base
+{
+public:
+    explicit via_(fork_server &server) : server_(server) {}
+
+    template <class PosixExecutor>
+    void on_fork_server_setup(PosixExecutor &e) const
+    {
+        e.request->server = &server_;
+    }
+
+private:
+    fork_server &server_;
+};
+
+template <>
+struct is_fork_server_compatible<via_> : boost::true_type {};
+
+template <>
+struct uses_fork_server<via_> : boost::true_type {};
+
+inline via_ via(fork_server &server)
+{
+    return via_(server);
+}
+
+}}}}
+
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_PATH_RESOLVER_HPP
+#define BOOST_PROCESS_POSIX_PATH_RESOLVER_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#if defined(__linux__)
+#   include <sys/inotify.h>
+#endif
+
+#if defined(__linux__) && defined(IN_NONBLOCK)
+#   define BOOST_PROCESS_POSIX_HAS_INOTIFY
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+// Caches the results of search_path including misses.
+//
+// Results are kept per value of PATH. On Linux the directories are
+// watched with inotify: a lookup which hits the cache costs a hash
+// lookup and one non-blocking read(2). Elsewhere, and for directories
+// which don't exist, the modification time of the directories is
+// compared instead. This doesn't detect permission changes of files.
+//
+// path_resolver is not thread-safe.
+class path_resolver : boost::noncopyable
+{
+public:
+    path_resolver() : inotify_fd_(-1)
+    {
+        open_inotify();
+    }
+
+    ~path_resolver()
+    {
+        if (inotify_fd_ != -1)
+            ::close(inotify_fd_);
+    }
+
+    std::string search_path(const std::string &filename,
+        const std::string &path = "")
+    {
+        const std::string *p = &path;
+        std::string env_path;
+        if (path.empty())
+        {
+            const char *env = ::getenv("PATH");
+            if (!env || !*env)
+                BOOST_PROCESS_THROW(std::runtime_error(
+                    "Environment variable PATH not found"));
+            env_path = env;
+            p = &env_path;
+        }
+
+        if (changed())
+            clear();
+
+        path_map::iterator it = paths_.find(*p);
+        if (it == paths_.end())
+            it = paths_.insert(std::make_pair(*p, make_entry(*p))).first;
+        else
+            validate(it->second);
+
+        result_map &results = it->second.results;
+        result_map::iterator r = results.find(filename);
+        if (r == results.end())
+            r = results.insert(std::make_pair(filename,
+                lookup(it->second, filename))).first;
+        return r->second;
+    }
+
+    void clear()
+    {
+        paths_.clear();
+#if defined(BOOST_PROCESS_POSIX_HAS_INOTIFY)
+        // Closing the inotify instance removes all watches.
+        if (inotify_fd_ != -1)
+            ::close(inotify_fd_);
+        open_inotify();
+#endif
+    }
+
+private:
+    struct directory
+    {
+        std::string name;
+        bool watched;
+        bool exists;
+        dev_t dev;
+        ino_t ino;
+        struct timespec mtime;
+    };
+
+    typedef boost::unordered_map<std::string, std::string> result_map;
+
+    struct path_entry
+    {
+        std::vector<directory> dirs;
+        result_map results;
+    };
+
+    typedef boost::unordered_map<std::string, path_entry> path_map;
+
+    void open_inotify()
+    {
+#if defined(BOOST_PROCESS_POSIX_HAS_INOTIFY)
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    bool changed()
+    {
+#if defined(BOOST_PROCESS_POSIX_HAS_INOTIFY)
+        if (inotify_fd_ == -1)
+            return false;
+        // Any event invalidates the whole cache. Directories in PATH
+        // rarely change.
+        char buf[4096];
+        ssize_t n;
+        bool events = false;
+        do
+        {
+            n = ::read(inotify_fd_, buf, sizeof(buf));
+            if (n > 0)
+                events = true;
+        } while (n > 0 || (n == -1 && errno == EINTR));
+        return events;
+#else
+        return false;
+#endif
+    }
+
+    static struct timespec mtime(const struct stat &st)
+    {
+#if defined(__APPLE__)
+        return st.st_mtimespec;
+#else
+        return st.st_mtim;
+#endif
+    }
+
+    void stamp(directory &d)
+    {
+        d.watched = false;
+#if defined(BOOST_PROCESS_POSIX_HAS_INOTIFY)
+        // The watch must be added before the directory is searched so
+        // that no change goes unnoticed.
+        if (inotify_fd_ != -1)
+        {
+            d.watched = ::inotify_add_watch(inotify_fd_, d.name.c_str(),
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF |
+                IN_ONLYDIR) != -1;
+        }
+#endif
+        struct stat st;
+        d.exists = ::stat(d.name.c_str(), &st) == 0;
+        if (d.exists)
+        {
+            d.dev = st.st_dev;
+            d.ino = st.st_ino;
+            d.mtime = mtime(st);
+        }
+    }
+
+    bool same_stamp(const directory &d)
+    {
+        struct stat st;
+        if (::stat(d.name.c_str(), &st) != 0)
+            return !d.exists;
+        struct timespec t = mtime(st);
+        return d.exists && d.dev == st.st_dev && d.ino == st.st_ino &&
+            d.mtime.tv_sec == t.tv_sec && d.mtime.tv_nsec == t.tv_nsec;
+    }
+
+    path_entry make_entry(const std::string &path)
+    {
+        path_entry e;
+        std::string::size_type begin = 0;
+        while (begin <= path.size())
+        {
+            std::string::size_type end = path.find(':', begin);
+            if (end == std::string::npos)
+                end = path.size();
+            if (end > begin)
+            {
+                directory d;
+                d.name.assign(path, begin, end - begin);
+                stamp(d);
+                e.dirs.push_back(d);
+            }
+            begin = end + 1;
+        }
+        return e;
+    }
+
+    void validate(path_entry &e)
+    {
+        bool stale = false;
+        for (std::size_t i = 0; i < e.dirs.size(); ++i)
+        {
+            directory &d = e.dirs[i];
+            if (!d.watched && !same_stamp(d))
+            {
+                stamp(d);
+                stale = true;
+            }
+        }
+        if (stale)
+            e.results.clear();
+    }
+
+    std::string lookup(const path_entry &e, const std::string &filename)
+    {
+        std::string p;
+        for (std::size_t i = 0; i < e.dirs.size(); ++i)
+        {
+            if (!e.dirs[i].exists)
+                continue;
+            p = e.dirs[i].name;
+            if (p[p.size() - 1] != '/')
+                p += '/';
+            p += filename;
+            if (!::access(p.c_str(), X_OK))
+                return p;
+        }
+        return std::string();
+    }
+
+    int inotify_fd_;
+    path_map paths_;
+};
+
+}}}
+
+#endif
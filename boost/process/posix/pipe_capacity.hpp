@@ -0,0 +1,133 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_PIPE_CAPACITY_HPP
+#define BOOST_PROCESS_POSIX_PIPE_CAPACITY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <climits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#if defined(__linux__) && defined(F_SETPIPE_SZ) && defined(F_GETPIPE_SZ)
+#   define BOOST_PROCESS_POSIX_HAS_PIPE_SZ
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+inline std::size_t read_pipe_max_size()
+{
+    std::size_t size = 1024 * 1024;
+    int fd = ::open("/proc/sys/fs/pipe-max-size", O_RDONLY | O_CLOEXEC);
+    if (fd != -1)
+    {
+        char buffer[32];
+        ssize_t n = ::read(fd, buffer, sizeof(buffer) - 1);
+        if (n > 0)
+        {
+            buffer[n] = '\0';
+            unsigned long value = std::strtoul(buffer, 0, 10);
+            if (value > 0)
+                size = value;
+        }
+        ::close(fd);
+    }
+    return size;
+}
+
+// Unprivileged processes can't grow a pipe beyond this limit. It is read
+// once, as changing it requires root and it's rarely changed at runtime.
+inline std::size_t pipe_max_size()
+{
+    static const std::size_t size = read_pipe_max_size();
+    return size;
+}
+
+inline int pipe_capacity(int fd)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_PIPE_SZ)
+    return ::fcntl(fd, F_GETPIPE_SZ);
+#else
+    (void)fd;
+    return PIPE_BUF;
+#endif
+}
+
+inline int set_pipe_capacity(int fd, std::size_t capacity)
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_PIPE_SZ)
+    std::size_t max = pipe_max_size();
+    if (capacity > max)
+        capacity = max;
+    if (capacity > INT_MAX)
+        capacity = INT_MAX;
+    int ret = ::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(capacity));
+    // A lower limit might apply if the user has too many pipe buffers
+    // already, keep the current size then.
+    if (ret == -1 && errno == EPERM)
+        ret = ::fcntl(fd, F_GETPIPE_SZ);
+    return ret;
+#else
+    (void)capacity;
+    return pipe_capacity(fd);
+#endif
+}
+
+}
+
+inline std::size_t pipe_capacity(int fd)
+{
+    int ret = detail::pipe_capacity(fd);
+    if (ret == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("fcntl(2) failed");
+    return ret;
+}
+
+inline std::size_t pipe_capacity(int fd, boost::system::error_code &ec)
+{
+    int ret = detail::pipe_capacity(fd);
+    if (ret == -1)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return 0;
+    }
+    ec.clear();
+    return ret;
+}
+
+inline std::size_t set_pipe_capacity(int fd, std::size_t capacity)
+{
+    int ret = detail::set_pipe_capacity(fd, capacity);
+    if (ret == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("fcntl(2) failed");
+    return ret;
+}
+
+inline std::size_t set_pipe_capacity(int fd, std::size_t capacity,
+    boost::system::error_code &ec)
+{
+    int ret = detail::set_pipe_capacity(fd, capacity);
+    if (ret == -1)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return 0;
+    }
+    ec.clear();
+    return ret;
+}
+
+}}}
+
+#endif
@@ -0,0 +1,299 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_PIPELINE_HPP
+#define BOOST_PROCESS_POSIX_PIPELINE_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/executor.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/create_pipe.hpp>
+#include <boost/process/posix/detail/dup_fd.hpp>
+#include <boost/process/posix/exec_stage.hpp>
+#include <boost/process/posix/initializers/initializer_base.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/fusion/algorithm/transformation/push_back.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/fusion/mpl.hpp>
+#include <boost/preprocessor/repetition/enum_binary_params.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
+#include <boost/preprocessor/repetition/repeat_from_to.hpp>
+#include <boost/container/vector.hpp>
+#include <boost/function.hpp>
+#include <boost/ref.hpp>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+// Binds the pipe ends of a stage and moves it into the process group of
+// the pipeline. Added after the user's initializers so it wins over them
+// for all but the outer ends of the pipeline.
+class pipeline_stage_io : public initializers::initializer_base
+{
+public:
+    pipeline_stage_io(int in, int out, bool group, pid_t pgid)
+        : in_(in), out_(out), group_(group), pgid_(pgid) {}
+
+    template <class PosixExecutor>
+    void on_fork_success(PosixExecutor &e) const
+    {
+        if (group_)
+            ::setpgid(e.pid, pgid_ ? pgid_ : e.pid);
+    }
+
+    template <class PosixExecutor>
+    void on_exec_setup(PosixExecutor &e) const
+    {
+        if (in_ != -1 && dup_fd(in_, STDIN_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+        if (out_ != -1 && dup_fd(out_, STDOUT_FILENO) == -1)
+            e.exec_failed(exec_stage_dup2);
+        if (group_ && ::setpgid(0, pgid_) == -1)
+            e.exec_failed(exec_stage_setpgid);
+    }
+
+    template <class PosixExecutor>
+    void on_spawn_setup(PosixExecutor &e) const
+    {
+        if (in_ != -1)
+            ::posix_spawn_file_actions_adddup2(e.file_actions, in_,
+                STDIN_FILENO);
+        if (out_ != -1)
+            ::posix_spawn_file_actions_adddup2(e.file_actions, out_,
+                STDOUT_FILENO);
+        if (group_)
+        {
+            short flags;
+            ::posix_spawnattr_getflags(e.attr, &flags);
+            ::posix_spawnattr_setflags(e.attr, flags | POSIX_SPAWN_SETPGROUP);
+            ::posix_spawnattr_setpgroup(e.attr, pgid_);
+        }
+    }
+
+private:
+    int in_;
+    int out_;
+    bool group_;
+    pid_t pgid_;
+};
+
+template <class Sequence>
+struct pipeline_stage
+{
+    Sequence seq;
+
+    explicit pipeline_stage(const Sequence &s) : seq(s) {}
+
+    child operator()(const pipeline_stage_io &io) const
+    {
+        return executor()(boost::fusion::push_back(seq, boost::cref(io)));
+    }
+};
+
+inline const char *create_pipe_call()
+{
+#if defined(BOOST_PROCESS_POSIX_HAS_PIPE2)
+    return "pipe2(2)";
+#else
+    return "pipe(2) or fcntl(2)";
+#endif
+}
+
+class scoped_fd
+{
+public:
+    explicit scoped_fd(int fd = -1) : fd_(fd) {}
+    ~scoped_fd() { reset(); }
+
+    int get() const { return fd_; }
+
+    int release()
+    {
+        int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+
+    void reset(int fd = -1)
+    {
+        if (fd_ != -1)
+            ::close(fd_);
+        fd_ = fd;
+    }
+
+private:
+    scoped_fd(const scoped_fd&);
+    scoped_fd &operator=(const scoped_fd&);
+
+    int fd_;
+};
+
+}
+
+namespace initializers {
+
+template <>
+struct is_spawnable<detail::pipeline_stage_io> : boost::true_type {};
+
+template <>
+struct is_vfork_safe<detail::pipeline_stage_io> : boost::true_type {};
+
+}
+
+// Each overload of stage() takes the initializers of one program. One
+// more initializer is added when the stage is started, and executor
+// supports up to ten.
+#define BOOST_PROCESS_POSIX_PIPELINE_STAGE(z, n, unused) \
+    template <BOOST_PP_ENUM_PARAMS_Z(z, n, class I)> \
+    pipeline &stage(BOOST_PP_ENUM_BINARY_PARAMS_Z(z, n, const I, &i)) \
+    { \
+        return add(boost::fusion::make_vector( \
+            BOOST_PP_ENUM_PARAMS_Z(z, n, i))); \
+    }
+
+class pipeline
+{
+public:
+    explicit pipeline(bool process_group = false)
+        : process_group_(process_group), failed_stage_(-1) {}
+
+    BOOST_PP_REPEAT_FROM_TO(1, 10, BOOST_PROCESS_POSIX_PIPELINE_STAGE, ~)
+
+    void start()
+    {
+        boost::system::error_code ec;
+        start(ec);
+        if (ec)
+        {
+            std::ostringstream os;
+            os << BOOST_PROCESS_SOURCE_LOCATION << detail::create_pipe_call()
+                << " failed for the pipe between stages " << failed_stage_
+                << " and " << failed_stage_ + 1;
+            BOOST_PROCESS_THROW(boost::system::system_error(ec, os.str()));
+        }
+    }
+
+    void start(boost::system::error_code &ec)
+    {
+        // Copies of initializers might own file descriptors like pipe ends
+        // bound to the last stage. They are released once all stages run.
+        stage_vector stages;
+        stages.swap(stages_);
+
+        ec.clear();
+        failed_stage_ = -1;
+        children_.clear();
+        detail::scoped_fd in;
+        for (std::size_t i = 0; i < stages.size(); ++i)
+        {
+            detail::scoped_fd out;
+            detail::scoped_fd next_in;
+            if (i + 1 < stages.size())
+            {
+                int fds[2];
+                if (detail::create_pipe(fds, O_CLOEXEC) == -1)
+                {
+                    failed_stage_ = static_cast<std::ptrdiff_t>(i);
+                    BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+                    return;
+                }
+                next_in.reset(fds[0]);
+                out.reset(fds[1]);
+            }
+            pid_t pgid = children_.empty() ? 0 : children_.front().pid;
+            children_.push_back(stages[i](detail::pipeline_stage_io(
+                in.get(), out.get(), process_group_, pgid)));
+            // Without the first stage there is no process group to join.
+            // Each later stage would lead a group of its own.
+            if (i == 0 && process_group_ && children_.front().pid == -1)
+            {
+                failed_stage_ = 0;
+                return;
+            }
+            in.reset(next_in.release());
+        }
+    }
+
+    std::size_t size() const { return children_.size(); }
+
+    // Index of the stage whose output pipe couldn't be created by the last
+    // call to start, or -1. The stages before it have been started. With a
+    // process group it is 0, too, if the first stage couldn't be started.
+    std::ptrdiff_t failed_stage() const { return failed_stage_; }
+
+    const child &operator[](std::size_t i) const { return children_[i]; }
+
+    pid_t process_group() const
+    {
+        return process_group_ && !children_.empty() ?
+            children_.front().pid : -1;
+    }
+
+    std::vector<int> wait_for_exit()
+    {
+        boost::system::error_code ec;
+        std::vector<int> statuses = wait_for_exit(ec);
+        if (ec)
+            BOOST_PROCESS_THROW(boost::system::system_error(ec,
+                BOOST_PROCESS_SOURCE_LOCATION "waitpid(2) failed"));
+        return statuses;
+    }
+
+    std::vector<int> wait_for_exit(boost::system::error_code &ec)
+    {
+        ec.clear();
+        std::vector<int> statuses(children_.size(), 0);
+        for (std::size_t i = 0; i < children_.size(); ++i)
+        {
+            if (children_[i].pid == -1)
+                continue;
+            pid_t ret;
+            do
+            {
+                ret = ::waitpid(children_[i].pid, &statuses[i], 0);
+            } while (ret == -1 && errno == EINTR);
+            if (ret == -1)
+                BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        }
+        return statuses;
+    }
+
+private:
+#undef BOOST_PROCESS_POSIX_PIPELINE_STAGE
+
+    template <class Sequence>
+    pipeline &add(const Sequence &seq)
+    {
+        stages_.push_back(detail::pipeline_stage<Sequence>(seq));
+        return *this;
+    }
+
+    typedef std::vector<
+        boost::function<child(const detail::pipeline_stage_io&)> >
+        stage_vector;
+
+    bool process_group_;
+    std::ptrdiff_t failed_stage_;
+    stage_vector stages_;
+    boost::container::vector<child> children_;
+};
+
+}}}
+
+#endif
@@ -0,0 +1,214 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_POSIX_SIGCHLD_SERVICE_HPP
+#define BOOST_PROCESS_POSIX_SIGCHLD_SERVICE_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/exit_info.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+#include <utility>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <errno.h>
+
+namespace boost { namespace process { namespace posix {
+
+namespace detail {
+
+template <class Handler>
+struct status_handler
+{
+    Handler handler_;
+
+    explicit status_handler(Handler handler) : handler_(handler) {}
+
+    void operator()(const boost::system::error_code &ec,
+        const exit_info &info)
+    {
+        handler_(ec, info.status);
+    }
+};
+
+}
+
+class sigchld_service
+    : public boost::asio::detail::service_base<sigchld_service>
+{
+public:
+    typedef boost::function<
+        void(const boost::system::error_code&, const exit_info&)
+    > handler_type;
+
+    explicit sigchld_service(boost::asio::io_service &io_service)
+        : boost::asio::detail::service_base<sigchld_service>(io_service),
+        io_service_(io_service), signals_(io_service, SIGCHLD),
+        strand_(io_service), waiting_(false)
+    {
+    }
+
+    template <class Handler>
+    void async_wait(pid_t pid, Handler handler)
+    {
+        async_wait_info(pid, detail::status_handler<Handler>(handler));
+    }
+
+    template <class Handler>
+    void async_wait_info(pid_t pid, Handler handler)
+    {
+        strand_.dispatch(boost::bind(&sigchld_service::do_async_wait, this,
+            pid, handler_type(handler)));
+    }
+
+private:
+    typedef boost::unordered_map<pid_t, handler_type> handler_map;
+
+    void shutdown_service()
+    {
+        handlers_.clear();
+    }
+
+    void do_async_wait(pid_t pid, const handler_type &handler)
+    {
+        std::pair<handler_map::iterator, bool> r =
+            handlers_.insert(handler_map::value_type(pid, handler));
+        if (!r.second)
+            r.first->second = handler;
+        // The child may have exited before the handler was registered.
+        reap_one(r.first);
+        wait();
+    }
+
+    void wait()
+    {
+        if (!waiting_ && !handlers_.empty())
+        {
+            waiting_ = true;
+            signals_.async_wait(strand_.wrap(signal_handler(this)));
+        }
+    }
+
+    struct signal_handler
+    {
+        sigchld_service *service_;
+
+        explicit signal_handler(sigchld_service *service)
+            : service_(service) {}
+
+        void operator()(const boost::system::error_code &ec, int) const
+        {
+            service_->on_signal(ec);
+        }
+    };
+
+    void on_signal(const boost::system::error_code &ec)
+    {
+        waiting_ = false;
+        if (ec == boost::asio::error::operation_aborted)
+            return;
+        reap();
+        wait();
+    }
+
+    // Only children a handler is registered for are reaped, so children
+    // started by other components can still be waited for by them.
+    // waitid(WNOWAIT) tells which child exited without reaping it, so
+    // every exit costs two system calls and one hash lookup no matter how
+    // many handlers are registered. If the exited child belongs to
+    // someone else, it stays a zombie and hides the children behind it.
+    // Then all registered children are checked one by one.
+    void reap()
+    {
+        while (!handlers_.empty())
+        {
+            siginfo_t info;
+            info.si_pid = 0;
+            int ret;
+            do
+            {
+                ret = ::waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT);
+            } while (ret == -1 && errno == EINTR);
+            if (ret == -1 || info.si_pid == 0)
+                return;
+            handler_map::iterator it = handlers_.find(info.si_pid);
+            if (it == handlers_.end())
+            {
+                reap_all();
+                return;
+            }
+            if (!reap_one(it))
+                return;
+        }
+    }
+
+    void reap_all()
+    {
+        handler_map::iterator it = handlers_.begin();
+        while (it != handlers_.end())
+        {
+            handler_map::iterator next = it;
+            ++next;
+            reap_one(it);
+            it = next;
+        }
+    }
+
+    // Calls wait4() for one registered child and removes its handler if
+    // the child has been reaped or can't be waited for.
+    bool reap_one(handler_map::iterator it)
+    {
+        int status;
+        struct rusage usage;
+        pid_t pid;
+        do
+        {
+            pid = ::wait4(it->first, &status, WNOHANG, &usage);
+        } while (pid == -1 && errno == EINTR);
+        if (pid == 0)
+            return false;
+        if (pid == -1)
+        {
+            boost::system::error_code ec;
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+            io_service_.post(boost::bind<void>(it->second, ec,
+                exit_info()));
+        }
+        else
+        {
+            complete(it->second, exit_info(status, usage));
+        }
+        handlers_.erase(it);
+        return true;
+    }
+
+    void complete(const handler_type &handler, const exit_info &info)
+    {
+        io_service_.post(boost::bind<void>(handler,
+            boost::system::error_code(), info));
+    }
+
+    boost::asio::io_service &io_service_;
+    boost::asio::signal_set signals_;
+    boost::asio::io_service::strand strand_;
+    bool waiting_;
+    handler_map handlers_;
+};
+
+}}}
+
+#endif
@@ -11,8 +11,15 @@
 #define BOOST_PROCESS_POSIX_TERMINATE_HPP
 
 #include <boost/process/config.hpp>
+#include <boost/process/posix/wait_for_exit.hpp>
 #include <boost/system/error_code.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/optional.hpp>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <signal.h>
+#include <errno.h>
 
 namespace boost { namespace process { namespace posix {
 
@@ -32,6 +39,104 @@ void terminate(const Process &p, boost::system::error_code &ec)
         ec.clear();
 }
 
+namespace detail {
+
+// Signals the process group of a child which was started with
+// new_process_group or new_session. If the child isn't the leader of its
+// process group, the function fails with EINVAL instead of signaling a
+// group the child merely belongs to (for example the group of the
+// parent).
+inline int kill_group(pid_t pid, int sig)
+{
+    pid_t pgid = ::getpgid(pid);
+    if (pgid == -1)
+        return -1;
+    if (pgid != pid)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    return ::killpg(pgid, sig);
+}
+
+}
+
+template <class Process>
+void terminate_group(const Process &p)
+{
+    if (detail::kill_group(p.pid, SIGKILL) == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("killpg(2) failed");
+}
+
+template <class Process>
+void terminate_group(const Process &p, boost::system::error_code &ec)
+{
+    if (detail::kill_group(p.pid, SIGKILL) == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+}
+
+struct escalation
+{
+    int signal;
+    boost::chrono::milliseconds grace_period;
+    int final_signal;
+
+    template <class Rep, class Period>
+    explicit escalation(const boost::chrono::duration<Rep, Period> &grace,
+        int sig = SIGTERM, int final_sig = SIGKILL)
+        : signal(sig),
+          grace_period(
+            boost::chrono::duration_cast<boost::chrono::milliseconds>(grace)),
+          final_signal(final_sig)
+    {
+    }
+};
+
+namespace detail {
+
+template <class Process>
+inline int escalate(const Process &p, const escalation &policy, int &status)
+{
+    if (::kill(p.pid, policy.signal) == -1)
+        return -1;
+    int ret = timed_wait(p, policy.grace_period.count(), status);
+    if (ret != 0)
+        return ret;
+    if (::kill(p.pid, policy.final_signal) == -1)
+        return -1;
+    pid_t pid;
+    do
+    {
+        pid = ::waitpid(p.pid, &status, 0);
+    } while (pid == -1 && errno == EINTR);
+    return pid == -1 ? -1 : 1;
+}
+
+}
+
+template <class Process>
+int terminate(const Process &p, const escalation &policy)
+{
+    int status;
+    if (detail::escalate(p, policy, status) == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("terminate() failed");
+    return status;
+}
+
+template <class Process>
+int terminate(const Process &p, const escalation &policy,
+    boost::system::error_code &ec)
+{
+    int status = 0;
+    if (detail::escalate(p, policy, status) == -1)
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+    else
+        ec.clear();
+    return status;
+}
+
 }}}
 
 #endif
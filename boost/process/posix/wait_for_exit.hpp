@@ -11,12 +11,94 @@
 #define BOOST_PROCESS_POSIX_WAIT_FOR_EXIT_HPP
 
 #include <boost/process/config.hpp>
+#include <boost/process/posix/exit_info.hpp>
 #include <boost/system/error_code.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/chrono/time_point.hpp>
+#include <boost/optional.hpp>
+#include <climits>
 #include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
 
 namespace boost { namespace process { namespace posix {
 
+namespace detail {
+
+inline long long monotonic_ms()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+template <class Rep, class Period>
+inline long long to_ms(const boost::chrono::duration<Rep, Period> &d)
+{
+    boost::chrono::milliseconds ms =
+        boost::chrono::duration_cast<boost::chrono::milliseconds>(d);
+    if (ms < d)
+        ++ms;
+    return ms.count();
+}
+
+// Sleeps until the child might have exited or ms milliseconds passed.
+// Without a pidfd the caller polls with waitpid(WNOHANG) and sleeps in
+// between. SIGCHLD isn't waited for as that would steal the signal from
+// sigchld_service or a signal handler. The sleep time doubles from 1 ms
+// up to 50 ms.
+inline bool wait_for_child_event(int pidfd, long long ms, long long &backoff)
+{
+    if (pidfd != -1)
+    {
+        struct pollfd pfd;
+        pfd.fd = pidfd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int timeout = ms > INT_MAX ? INT_MAX : static_cast<int>(ms);
+        return ::poll(&pfd, 1, timeout) != -1 || errno == EINTR;
+    }
+
+    long long sleep_ms = backoff < ms ? backoff : ms;
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(sleep_ms / 1000);
+    ts.tv_nsec = static_cast<long>(sleep_ms % 1000) * 1000000L;
+    ::nanosleep(&ts, 0);
+    if (backoff < 50)
+        backoff = backoff * 2 < 50 ? backoff * 2 : 50;
+    return true;
+}
+
+// Returns 1 if the child exited, 0 if the timeout expired and -1 if an
+// error occured.
+template <class Process>
+inline int timed_wait(const Process &p, long long ms, int &status)
+{
+    long long deadline = monotonic_ms() + ms;
+    long long backoff = 1;
+    for (;;)
+    {
+        pid_t ret = ::waitpid(p.pid, &status, WNOHANG);
+        if (ret == -1 && errno == EINTR)
+            continue;
+        if (ret == -1)
+            return -1;
+        if (ret != 0)
+            return 1;
+        long long remaining = deadline - monotonic_ms();
+        if (remaining <= 0)
+            return 0;
+        if (!wait_for_child_event(p.pidfd, remaining, backoff))
+            return -1;
+    }
+}
+
+}
+
 template <class Process>
 inline int wait_for_exit(const Process &p)
 {
@@ -47,6 +129,87 @@ inline int wait_for_exit(const Process &p, boost::system::error_code &ec)
     return status;
 }
 
+template <class Process>
+inline exit_info wait_for_exit_info(const Process &p)
+{
+    pid_t ret;
+    int status;
+    struct rusage usage;
+    do
+    {
+        ret = ::wait4(p.pid, &status, 0, &usage);
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("wait4(2) failed");
+    return exit_info(status, usage);
+}
+
+template <class Process>
+inline exit_info wait_for_exit_info(const Process &p,
+    boost::system::error_code &ec)
+{
+    pid_t ret;
+    int status;
+    struct rusage usage;
+    do
+    {
+        ret = ::wait4(p.pid, &status, 0, &usage);
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return exit_info();
+    }
+    ec.clear();
+    return exit_info(status, usage);
+}
+
+template <class Process, class Rep, class Period>
+inline boost::optional<int> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time)
+{
+    int status;
+    int ret = detail::timed_wait(p, detail::to_ms(rel_time), status);
+    if (ret == -1)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("waitpid(2) failed");
+    if (ret == 0)
+        return boost::none;
+    return status;
+}
+
+template <class Process, class Rep, class Period>
+inline boost::optional<int> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time,
+    boost::system::error_code &ec)
+{
+    int status;
+    int ret = detail::timed_wait(p, detail::to_ms(rel_time), status);
+    if (ret == -1)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return boost::none;
+    }
+    ec.clear();
+    if (ret == 0)
+        return boost::none;
+    return status;
+}
+
+template <class Process, class Clock, class Duration>
+inline boost::optional<int> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time)
+{
+    return wait_for_exit_for(p, abs_time - Clock::now());
+}
+
+template <class Process, class Clock, class Duration>
+inline boost::optional<int> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time,
+    boost::system::error_code &ec)
+{
+    return wait_for_exit_for(p, abs_time - Clock::now(), ec);
+}
+
 }}}
 
 #endif
@@ -20,6 +20,8 @@
 
 #include BOOST_PROCESS_PLATFORM_PROMOTE_PATH(wait_for_exit)
 BOOST_PROCESS_PLATFORM_PROMOTE_NAMESPACE(wait_for_exit)
+BOOST_PROCESS_PLATFORM_PROMOTE_NAMESPACE(wait_for_exit_for)
+BOOST_PROCESS_PLATFORM_PROMOTE_NAMESPACE(wait_for_exit_until)
 
 #if defined(BOOST_PROCESS_DOXYGEN)
 namespace boost { namespace process {
@@ -52,6 +54,55 @@ int_type wait_for_exit(const Process &p);
 template <class Process>
 int_type wait_for_exit(const Process &p, boost::system::error_code &ec);
 
+/**
+ * Waits for a process to exit for at most the given duration.
+ *
+ * Returns the value boost::process::wait_for_exit would return or an
+ * empty optional if the process didn't exit in time.
+ *
+ * On Linux the function polls the pidfd of the process. If there is no
+ * pidfd \c waitpid is called with \c WNOHANG in intervals of up to 50 ms.
+ * \c SIGCHLD isn't consumed. No extra threads are used.
+ *
+ * \note This is a blocking function.
+ *
+ * \throws boost::system::system_error in case of an error
+ */
+template <class Process, class Rep, class Period>
+boost::optional<int_type> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time);
+
+/**
+ * Waits for a process to exit for at most the given duration.
+ *
+ * \note This is a blocking function.
+ */
+template <class Process, class Rep, class Period>
+boost::optional<int_type> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time,
+    boost::system::error_code &ec);
+
+/**
+ * Waits for a process to exit until the given point in time.
+ *
+ * \note This is a blocking function.
+ *
+ * \throws boost::system::system_error in case of an error
+ */
+template <class Process, class Clock, class Duration>
+boost::optional<int_type> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time);
+
+/**
+ * Waits for a process to exit until the given point in time.
+ *
+ * \note This is a blocking function.
+ */
+template <class Process, class Clock, class Duration>
+boost::optional<int_type> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time,
+    boost::system::error_code &ec);
+
 }}
 #endif
 
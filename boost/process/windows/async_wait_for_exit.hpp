@@ -0,0 +1,81 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROCESS_WINDOWS_ASYNC_WAIT_FOR_EXIT_HPP
+#define BOOST_PROCESS_WINDOWS_ASYNC_WAIT_FOR_EXIT_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/windows/object_handle.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <Windows.h>
+
+namespace boost { namespace process { namespace windows {
+
+namespace detail {
+
+template <class Handler>
+struct wait_for_exit_op
+{
+    boost::asio::windows::object_handle handle;
+    Handler handler;
+
+    wait_for_exit_op(boost::asio::io_service &io_service, HANDLE h,
+        Handler hd) : handle(io_service, h), handler(hd) {}
+};
+
+template <class Handler>
+struct wait_for_exit_handler
+{
+    boost::shared_ptr<wait_for_exit_op<Handler> > op_;
+
+    explicit wait_for_exit_handler(
+        const boost::shared_ptr<wait_for_exit_op<Handler> > &op) : op_(op) {}
+
+    void operator()(const boost::system::error_code &ec)
+    {
+        DWORD exit_code = 1;
+        if (ec)
+        {
+            op_->handler(ec, exit_code);
+            return;
+        }
+        boost::system::error_code wait_ec;
+        if (!::GetExitCodeProcess(op_->handle.native_handle(), &exit_code))
+            BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(wait_ec);
+        op_->handler(wait_ec, exit_code);
+    }
+};
+
+}
+
+template <class Process, class Handler>
+void async_wait_for_exit(boost::asio::io_service &io_service,
+    const Process &p, Handler handler)
+{
+    HANDLE h;
+    if (!::DuplicateHandle(::GetCurrentProcess(), p.process_handle(),
+        ::GetCurrentProcess(), &h, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+        boost::system::error_code ec;
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        io_service.post(boost::bind<void>(handler, ec, DWORD(1)));
+        return;
+    }
+
+    boost::shared_ptr<detail::wait_for_exit_op<Handler> > op(
+        new detail::wait_for_exit_op<Handler>(io_service, h, handler));
+    op->handle.async_wait(detail::wait_for_exit_handler<Handler>(op));
+}
+
+}}}
+
+#endif
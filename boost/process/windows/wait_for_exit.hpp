@@ -12,10 +12,31 @@
 
 #include <boost/process/config.hpp>
 #include <boost/system/error_code.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/chrono/time_point.hpp>
+#include <boost/optional.hpp>
 #include <Windows.h>
 
 namespace boost { namespace process { namespace windows {
 
+namespace detail {
+
+template <class Rep, class Period>
+inline DWORD to_timeout(const boost::chrono::duration<Rep, Period> &d)
+{
+    boost::chrono::milliseconds ms =
+        boost::chrono::duration_cast<boost::chrono::milliseconds>(d);
+    if (ms < d)
+        ++ms;
+    if (ms.count() <= 0)
+        return 0;
+    if (ms.count() >= INFINITE)
+        return INFINITE - 1;
+    return static_cast<DWORD>(ms.count());
+}
+
+}
+
 template <class Process>
 inline DWORD wait_for_exit(const Process &p)
 {
@@ -44,6 +65,65 @@ inline DWORD wait_for_exit(const Process &p, boost::system::error_code &ec)
     return exit_code;
 }
 
+template <class Process, class Rep, class Period>
+inline boost::optional<DWORD> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time)
+{
+    DWORD ret = ::WaitForSingleObject(p.process_handle(),
+        detail::to_timeout(rel_time));
+    if (ret == WAIT_FAILED)
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("WaitForSingleObject() failed");
+    if (ret == WAIT_TIMEOUT)
+        return boost::none;
+
+    DWORD exit_code;
+    if (!::GetExitCodeProcess(p.process_handle(), &exit_code))
+        BOOST_PROCESS_THROW_LAST_SYSTEM_ERROR("GetExitCodeProcess() failed");
+
+    return exit_code;
+}
+
+template <class Process, class Rep, class Period>
+inline boost::optional<DWORD> wait_for_exit_for(const Process &p,
+    const boost::chrono::duration<Rep, Period> &rel_time,
+    boost::system::error_code &ec)
+{
+    DWORD ret = ::WaitForSingleObject(p.process_handle(),
+        detail::to_timeout(rel_time));
+    if (ret == WAIT_FAILED)
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return boost::none;
+    }
+    ec.clear();
+    if (ret == WAIT_TIMEOUT)
+        return boost::none;
+
+    DWORD exit_code;
+    if (!::GetExitCodeProcess(p.process_handle(), &exit_code))
+    {
+        BOOST_PROCESS_RETURN_LAST_SYSTEM_ERROR(ec);
+        return boost::none;
+    }
+
+    return exit_code;
+}
+
+template <class Process, class Clock, class Duration>
+inline boost::optional<DWORD> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time)
+{
+    return wait_for_exit_for(p, abs_time - Clock::now());
+}
+
+template <class Process, class Clock, class Duration>
+inline boost::optional<DWORD> wait_for_exit_until(const Process &p,
+    const boost::chrono::time_point<Clock, Duration> &abs_time,
+    boost::system::error_code &ec)
+{
+    return wait_for_exit_for(p, abs_time - Clock::now(), ec);
+}
+
 }}}
 
 #endif
@@ -0,0 +1,74 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Starts many short commands with async_run() in one thread and collects
+// their exit status and output. At most in_flight commands run at the
+// same time, as every running command holds up to three file descriptors
+// (the pidfd and the memfds for stdout and stderr). Every result is printed on one line as space-separated key=value
+// pairs.
+
+#include <boost/process.hpp>
+#include <boost/process/posix/async_run.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/chrono.hpp>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+namespace chrono = boost::chrono;
+
+struct collect
+{
+    std::size_t &completed_;
+    std::size_t &failed_;
+    std::size_t &bytes_;
+
+    collect(std::size_t &completed, std::size_t &failed, std::size_t &bytes)
+        : completed_(completed), failed_(failed), bytes_(bytes) {}
+
+    void operator()(const boost::system::error_code &ec,
+        const bp::posix::run_result &r)
+    {
+        ++completed_;
+        if (ec || r.info.exit_code != 0)
+            ++failed_;
+        bytes_ += boost::asio::buffer_size(r.out);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    std::size_t count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    std::size_t in_flight = argc > 2 ? std::atoi(argv[2]) : 256;
+    std::string exe = argc > 3 ? argv[3] : "/bin/echo";
+
+    boost::asio::io_service io_service;
+    std::size_t completed = 0, failed = 0, bytes = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bp::posix::async_run(io_service,
+            boost::fusion::make_vector(bpi::run_exe(exe),
+                bpi::set_cmd_line(exe + " hello")),
+            bp::posix::capture_stdout | bp::posix::capture_stderr,
+            collect(completed, failed, bytes));
+        while (i + 1 - completed >= in_flight)
+            io_service.run_one();
+    }
+    io_service.run();
+    chrono::nanoseconds d = chrono::steady_clock::now() - start;
+
+    double seconds = d.count() / 1e9;
+    std::cout << "bench=async_run count=" << completed << " failed=" <<
+        failed << " bytes=" << bytes << " children_per_second=" <<
+        completed / seconds << std::endl;
+}
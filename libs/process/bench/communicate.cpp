@@ -0,0 +1,159 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares ways to pass input to cat(1) and read its output. "sequential"
+// writes all input before it reads the output. It deadlocks as soon as
+// the data doesn't fit into the pipes and is only measured for small
+// inputs. "thread" writes in a second thread. "communicate" and
+// "async_communicate" multiplex the pipes in one thread. Every result is
+// printed on one line as space-separated key=value pairs.
+
+#include <boost/process.hpp>
+#include <boost/process/posix/communicate.hpp>
+#include <boost/process/posix/detail/write_all.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/chrono.hpp>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+namespace bio = boost::iostreams;
+namespace chrono = boost::chrono;
+
+struct cat_process
+{
+    bp::pipe in;
+    bp::pipe out;
+    bp::child c;
+
+    cat_process() : in(bp::create_pipe(O_CLOEXEC)),
+        out(bp::create_pipe(O_CLOEXEC)), c(start(in, out)) {}
+
+    static bp::child start(bp::pipe &in, bp::pipe &out)
+    {
+        bio::file_descriptor_source source(in.source, bio::close_handle);
+        bio::file_descriptor_sink sink(out.sink, bio::close_handle);
+        return bp::execute(
+            bpi::run_exe("/bin/cat"),
+            bpi::bind_stdin(source),
+            bpi::bind_stdout(sink),
+            bpi::throw_on_error()
+        );
+    }
+};
+
+void read_all(int fd, std::string &output)
+{
+    char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+        output.append(buffer, n);
+    ::close(fd);
+}
+
+void sequential(const std::string &input, std::string &output)
+{
+    cat_process p;
+    bp::posix::detail::write_all(p.in.sink, input.data(), input.size());
+    ::close(p.in.sink);
+    read_all(p.out.source, output);
+    bp::wait_for_exit(p.c);
+}
+
+struct writer_args
+{
+    int fd;
+    const std::string *input;
+};
+
+void *write_input(void *arg)
+{
+    writer_args *args = static_cast<writer_args*>(arg);
+    bp::posix::detail::write_all(args->fd, args->input->data(),
+        args->input->size());
+    ::close(args->fd);
+    return 0;
+}
+
+void thread(const std::string &input, std::string &output)
+{
+    cat_process p;
+    writer_args args = { p.in.sink, &input };
+    pthread_t t;
+    ::pthread_create(&t, 0, write_input, &args);
+    read_all(p.out.source, output);
+    ::pthread_join(t, 0);
+    bp::wait_for_exit(p.c);
+}
+
+void communicate(const std::string &input, std::string &output)
+{
+    cat_process p;
+    std::string error;
+    bp::posix::communicate(p.c, p.in.sink, boost::asio::buffer(input),
+        p.out.source, output, -1, error);
+}
+
+void ignore_result(const boost::system::error_code&, int) {}
+
+void async_communicate(const std::string &input, std::string &output)
+{
+    cat_process p;
+    std::string error;
+    boost::asio::io_service io_service;
+    bp::posix::async_communicate(io_service, p.c, p.in.sink,
+        boost::asio::buffer(input), p.out.source, output, -1, error,
+        ignore_result);
+    io_service.run();
+}
+
+void run(const char *method, void (*f)(const std::string&, std::string&),
+    std::size_t size, int iterations)
+{
+    std::string input(size, 'x');
+    chrono::nanoseconds total(0);
+    for (int i = 0; i < iterations; ++i)
+    {
+        std::string output;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        f(input, output);
+        total += chrono::steady_clock::now() - start;
+        if (output.size() != size)
+            std::cerr << method << ": output incomplete" << std::endl;
+    }
+    double seconds = total.count() / 1e9;
+    std::cout << "bench=communicate method=" << method << " kb=" <<
+        size / 1024 << " mb_per_second=" <<
+        iterations * (size / (1024.0 * 1024.0)) / seconds <<
+        " us_per_call=" << total.count() / 1000 / iterations << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t large_mb = argc > 1 ? std::atoi(argv[1]) : 64;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::size_t small = 16 * 1024;
+    run("sequential", sequential, small, 100 * iterations);
+    run("thread", thread, small, 100 * iterations);
+    run("communicate", communicate, small, 100 * iterations);
+    run("async_communicate", async_communicate, small, 100 * iterations);
+
+    std::size_t large = large_mb * 1024 * 1024;
+    run("thread", thread, large, iterations);
+    run("communicate", communicate, large, iterations);
+    run("async_communicate", async_communicate, large, iterations);
+}
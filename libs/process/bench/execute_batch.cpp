@@ -0,0 +1,83 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares starting children one by one with execute() against
+// execute_batch(). Every result is printed on one line as space-separated
+// key=value pairs.
+
+#include <boost/process.hpp>
+#include <boost/process/posix/execute_batch.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+namespace chrono = boost::chrono;
+
+struct numbered_args
+{
+    const std::string &exe_;
+
+    explicit numbered_args(const std::string &exe) : exe_(exe) {}
+
+    bpi::set_cmd_line operator()(std::size_t i) const
+    {
+        return bpi::set_cmd_line(exe_ + " " +
+            boost::lexical_cast<std::string>(i));
+    }
+};
+
+void report(const char *name, std::size_t count, chrono::nanoseconds d)
+{
+    double seconds = d.count() / 1e9;
+    std::cout << "bench=" << name << " children_per_second=" <<
+        count / seconds << '\n' << "bench=" << name << " ns_per_child=" <<
+        d.count() / count << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t count = argc > 1 ? std::atoi(argv[1]) : 500;
+    std::string exe = argc > 2 ? argv[2] : "/bin/true";
+    std::vector<std::string> env(64, "BOOST_PROCESS_BENCH=1");
+
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        std::vector<pid_t> pids;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            boost::system::error_code ec;
+            bp::child c = bp::execute(
+                bpi::run_exe(exe),
+                numbered_args(exe)(i),
+                bpi::set_env(env),
+                bpi::set_on_error(ec)
+            );
+            pids.push_back(c.pid);
+        }
+        report("execute", count, chrono::steady_clock::now() - start);
+        for (std::size_t i = 0; i < pids.size(); ++i)
+            bp::wait_for_exit(bp::child(pids[i]));
+    }
+
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bp::posix::batch_result r = bp::posix::execute_batch(count,
+            boost::fusion::make_vector(bpi::run_exe(exe), bpi::set_env(env)),
+            numbered_args(exe));
+        report("execute_batch", count, chrono::steady_clock::now() - start);
+        for (std::size_t i = 0; i < r.children.size(); ++i)
+            bp::wait_for_exit(r.children[i]);
+    }
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares feeding a memory buffer to the stdin of a child through a
+// file_descriptor_sink with feed_stdin(). The child is cat(1) writing to
+// /dev/null. Every result is printed on one line as space-separated
+// key=value pairs.
+
+#include <boost/process.hpp>
+#include <boost/process/posix/feed_stdin.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+namespace bio = boost::iostreams;
+namespace chrono = boost::chrono;
+
+bp::child start_cat(bp::pipe &p)
+{
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::file_descriptor_sink null("/dev/null");
+    return bp::execute(
+        bpi::run_exe("/bin/cat"),
+        bpi::bind_stdin(source),
+        bpi::bind_stdout(null),
+        bpi::throw_on_error()
+    );
+}
+
+// Writes the buffer in chunks like code which doesn't know about
+// feed_stdin() does.
+void feed_iostreams(int sink, const char *data, std::size_t size)
+{
+    bio::file_descriptor_sink s(sink, bio::close_handle);
+    const std::size_t chunk = 64 * 1024;
+    for (std::size_t i = 0; i < size; i += chunk)
+        s.write(data + i, (std::min)(chunk, size - i));
+}
+
+void feed(int sink, const char *data, std::size_t size, int flags)
+{
+    bp::posix::feed_stdin(sink, boost::asio::buffer(data, size), flags);
+    ::close(sink);
+}
+
+void run(const char *method, const char *data, std::size_t size,
+    int repetitions, int flags)
+{
+    chrono::nanoseconds total(0);
+    for (int i = 0; i < repetitions; ++i)
+    {
+        bp::pipe p = bp::create_pipe(O_CLOEXEC);
+        bp::child c = start_cat(p);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (flags == -1)
+            feed_iostreams(p.sink, data, size);
+        else
+            feed(p.sink, data, size, flags);
+        bp::wait_for_exit(c);
+        total += chrono::steady_clock::now() - start;
+    }
+    double seconds = total.count() / 1e9;
+    std::cout << "bench=feed_stdin method=" << method << " mb=" <<
+        size / (1024 * 1024) << " mb_per_second=" <<
+        repetitions * (size / (1024.0 * 1024.0)) / seconds << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t mb = argc > 1 ? std::atoi(argv[1]) : 200;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::size_t size = mb * 1024 * 1024;
+
+    // mmap() returns page-aligned memory, so feed_gift can be used.
+    void *data = ::mmap(0, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED)
+        return EXIT_FAILURE;
+    std::memset(data, 'x', size);
+    const char *p = static_cast<const char*>(data);
+
+    run("iostreams", p, size, repetitions, -1);
+    run("writev", p, size, repetitions, bp::posix::feed_default);
+    run("vmsplice", p, size, repetitions, bp::posix::feed_zero_copy);
+    run("vmsplice_gift", p, size, repetitions, bp::posix::feed_gift);
+
+    ::munmap(data, size);
+}
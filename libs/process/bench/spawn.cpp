@@ -0,0 +1,441 @@
+// Copyright (c) 2006, 2007 Julio M. Merino Vidal
+// Copyright (c) 2008 Ilya Sokolov, Boris Schaeling
+// Copyright (c) 2009 Boris Schaeling
+// Copyright (c) 2010 Felipe Tanus, Boris Schaeling
+// Copyright (c) 2011, 2012 Jeff Flinn, Boris Schaeling
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Measures the cost of starting programs with the different backends of
+// the POSIX executor (posix_spawn, vfork, fork and the fork server):
+//
+//   spawn_latency     time execute() takes until the program was started
+//   spawn_throughput  programs started per second, waited for afterwards
+//   wait_latency      time from closing the stdin of cat to the return
+//                     of wait_for_exit
+//   pipe_throughput   bytes per second read from a child's stdout
+//
+// The first three are measured for several parent RSS sizes, numbers of
+// open file descriptors and numbers of threads. By default one parameter
+// is varied at a time; --cross measures all combinations. Every result
+// is printed on one line as space-separated key=value pairs.
+
+#include <boost/process.hpp>
+#include <boost/process/posix/argv_builder.hpp>
+#include <boost/process/posix/fork_server.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/program_options.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+namespace bp = boost::process;
+namespace bpi = boost::process::initializers;
+namespace bio = boost::iostreams;
+namespace po = boost::program_options;
+namespace chrono = boost::chrono;
+
+struct vfork_noop
+{
+    void operator()(bp::executor&) const {}
+};
+
+struct fork_noop
+{
+    void operator()(bp::executor&) const {}
+};
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+template <>
+struct is_vfork_safe<vfork_noop> : boost::true_type {};
+
+}}}}
+
+enum backend { backend_spawn, backend_vfork, backend_fork, backend_fork_server };
+
+const char *backend_names[] = { "posix_spawn", "vfork", "fork", "fork_server" };
+
+struct config
+{
+    std::size_t rss_mb;
+    std::size_t fds;
+    std::size_t threads;
+};
+
+void print(const char *bench, const char *backend, const config &c,
+    const char *metric, double value)
+{
+    std::cout << "bench=" << bench << " backend=" << backend <<
+        " rss_mb=" << c.rss_mb << " fds=" << c.fds << " threads=" <<
+        c.threads << ' ' << metric << '=' << value << std::endl;
+}
+
+void print_stats(const char *bench, const char *backend, const config &c,
+    std::vector<double> &ns)
+{
+    if (ns.empty())
+        return;
+    std::sort(ns.begin(), ns.end());
+    print(bench, backend, c, "median_ns", ns[ns.size() / 2]);
+    print(bench, backend, c, "p99_ns", ns[ns.size() * 99 / 100]);
+}
+
+double elapsed_ns(chrono::steady_clock::time_point start)
+{
+    return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start).count());
+}
+
+bp::child start(backend b, const std::string &exe,
+    const bp::posix::argv_builder &args, bp::posix::fork_server &server,
+    boost::system::error_code &ec)
+{
+    switch (b)
+    {
+    case backend_vfork:
+        return bp::execute(bpi::run_exe(exe), bpi::set_args(args),
+            bpi::inherit_env(), bpi::on_exec_setup(vfork_noop()),
+            bpi::set_on_error(ec));
+    case backend_fork:
+        return bp::execute(bpi::run_exe(exe), bpi::set_args(args),
+            bpi::inherit_env(), bpi::on_exec_setup(fork_noop()),
+            bpi::set_on_error(ec));
+    case backend_fork_server:
+        return bp::execute(bpi::run_exe(exe), bpi::set_args(args),
+            bpi::inherit_env(), bpi::via(server), bpi::set_on_error(ec));
+    default:
+        return bp::execute(bpi::run_exe(exe), bpi::set_args(args),
+            bpi::inherit_env(), bpi::set_on_error(ec));
+    }
+}
+
+// Keeps a number of threads blocked on a pipe, an anonymous mapping of
+// touched pages and a number of open file descriptors alive.
+class parent_state
+{
+public:
+    parent_state() : mem_(0), mem_size_(0)
+    {
+        stop_[0] = stop_[1] = -1;
+    }
+
+    ~parent_state()
+    {
+        reset();
+    }
+
+    bool apply(const config &c)
+    {
+        reset();
+        mem_size_ = c.rss_mb << 20;
+        if (mem_size_)
+        {
+            mem_ = ::mmap(0, mem_size_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem_ == MAP_FAILED)
+            {
+                mem_ = 0;
+                return false;
+            }
+            std::memset(mem_, 1, mem_size_);
+        }
+        for (std::size_t i = 0; i < c.fds; ++i)
+        {
+            int fd = ::fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 3);
+            if (fd == -1)
+                return false;
+            fds_.push_back(fd);
+        }
+        if (c.threads && ::pipe2(stop_, O_CLOEXEC) == -1)
+            return false;
+        for (std::size_t i = 0; i < c.threads; ++i)
+        {
+            pthread_t t;
+            if (::pthread_create(&t, 0, idle, &stop_[0]) != 0)
+                return false;
+            threads_.push_back(t);
+        }
+        return true;
+    }
+
+    void reset()
+    {
+        if (stop_[1] != -1)
+            ::close(stop_[1]);
+        for (std::size_t i = 0; i < threads_.size(); ++i)
+            ::pthread_join(threads_[i], 0);
+        threads_.clear();
+        if (stop_[0] != -1)
+            ::close(stop_[0]);
+        stop_[0] = stop_[1] = -1;
+        for (std::size_t i = 0; i < fds_.size(); ++i)
+            ::close(fds_[i]);
+        fds_.clear();
+        if (mem_)
+            ::munmap(mem_, mem_size_);
+        mem_ = 0;
+    }
+
+private:
+    static void *idle(void *arg)
+    {
+        char c;
+        while (::read(*static_cast<int*>(arg), &c, 1) == -1 && errno == EINTR)
+            ;
+        return 0;
+    }
+
+    void *mem_;
+    std::size_t mem_size_;
+    std::vector<int> fds_;
+    std::vector<pthread_t> threads_;
+    int stop_[2];
+};
+
+void spawn_latency(backend b, const config &c, std::size_t iterations,
+    const std::string &exe, bp::posix::fork_server &server)
+{
+    bp::posix::argv_builder args;
+    args.arg(exe);
+    std::vector<double> ns;
+    ns.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        boost::system::error_code ec;
+        chrono::steady_clock::time_point t = chrono::steady_clock::now();
+        bp::child child = start(b, exe, args, server, ec);
+        double d = elapsed_ns(t);
+        if (ec)
+        {
+            std::cerr << backend_names[b] << ": " << ec.message() << std::endl;
+            return;
+        }
+        bp::wait_for_exit(child);
+        ns.push_back(d);
+    }
+    print_stats("spawn_latency", backend_names[b], c, ns);
+}
+
+void spawn_throughput(backend b, const config &c, std::size_t iterations,
+    const std::string &exe, bp::posix::fork_server &server)
+{
+    bp::posix::argv_builder args;
+    args.arg(exe);
+    std::vector<pid_t> pids;
+    pids.reserve(iterations);
+    chrono::steady_clock::time_point t = chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        boost::system::error_code ec;
+        bp::child child = start(b, exe, args, server, ec);
+        if (!ec)
+            pids.push_back(child.pid);
+    }
+    for (std::size_t i = 0; i < pids.size(); ++i)
+    {
+        while (::waitpid(pids[i], 0, 0) == -1 && errno == EINTR)
+            ;
+    }
+    print("spawn_throughput", backend_names[b], c, "children_per_second",
+        pids.size() / (elapsed_ns(t) / 1e9));
+}
+
+void wait_latency(const config &c, std::size_t iterations,
+    const std::string &cat)
+{
+    std::vector<double> ns;
+    ns.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        boost::system::error_code ec;
+        bp::pipe p = bp::create_pipe(O_CLOEXEC);
+        bp::child child(-1);
+        {
+            bio::file_descriptor_source source(p.source, bio::close_handle);
+            child = bp::execute(bpi::run_exe(cat), bpi::bind_stdin(source),
+                bpi::set_on_error(ec));
+        }
+        chrono::steady_clock::time_point t = chrono::steady_clock::now();
+        ::close(p.sink);
+        if (ec)
+            return;
+        bp::wait_for_exit(child);
+        ns.push_back(elapsed_ns(t));
+    }
+    print_stats("wait_latency", "default", c, ns);
+}
+
+void pipe_throughput(std::size_t capacity, std::size_t mb,
+    const std::string &head)
+{
+    boost::system::error_code ec;
+    std::size_t actual;
+    bp::pipe p = capacity ? bp::create_pipe(O_CLOEXEC, capacity, actual) :
+        bp::create_pipe(O_CLOEXEC);
+    if (!capacity)
+        actual = bp::posix::pipe_capacity(p.source, ec);
+    bp::posix::argv_builder args;
+    args.arg(head).arg("-c").arg(mb << 20).arg("/dev/zero");
+
+    chrono::steady_clock::time_point t = chrono::steady_clock::now();
+    bp::child child(-1);
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        child = bp::execute(bpi::run_exe(head), bpi::set_args(args),
+            bpi::bind_stdout(sink), bpi::set_on_error(ec));
+    }
+    std::vector<char> buffer(1 << 20);
+    std::size_t total = 0;
+    for (;;)
+    {
+        ssize_t n = ::read(p.source, &buffer[0], buffer.size());
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        total += n;
+    }
+    double d = elapsed_ns(t);
+    ::close(p.source);
+    bp::wait_for_exit(child);
+    std::cout << "bench=pipe_throughput capacity=" << actual <<
+        " bytes=" << total << " bytes_per_second=" << total / (d / 1e9) <<
+        std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    // Started first while the process is small and has no threads.
+    bp::posix::fork_server server;
+    server.start();
+
+    std::size_t iterations;
+    std::size_t pipe_mb;
+    std::vector<std::size_t> rss_mb, fds, threads;
+    po::options_description desc("Options");
+    desc.add_options()
+        ("help", "show this message")
+        ("iterations", po::value<std::size_t>(&iterations)->default_value(200),
+            "programs started per measurement")
+        ("rss-mb", po::value<std::vector<std::size_t> >(&rss_mb)->multitoken(),
+            "parent RSS sizes in MiB (default: 1 64 1024)")
+        ("fds", po::value<std::vector<std::size_t> >(&fds)->multitoken(),
+            "numbers of open file descriptors (default: 0 1024 16384)")
+        ("threads", po::value<std::vector<std::size_t> >(&threads)->multitoken(),
+            "numbers of idle threads (default: 0 8 64)")
+        ("pipe-mb", po::value<std::size_t>(&pipe_mb)->default_value(512),
+            "MiB read through a pipe")
+        ("cross", "measure all combinations of the parameters");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    if (rss_mb.empty())
+    {
+        rss_mb.push_back(1);
+        rss_mb.push_back(64);
+        rss_mb.push_back(1024);
+    }
+    if (fds.empty())
+    {
+        fds.push_back(0);
+        fds.push_back(1024);
+        fds.push_back(16384);
+    }
+    if (threads.empty())
+    {
+        threads.push_back(0);
+        threads.push_back(8);
+        threads.push_back(64);
+    }
+
+    struct rlimit rl;
+    if (::getrlimit(RLIMIT_NOFILE, &rl) == 0)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    std::string exe = bp::search_path("true");
+    std::string cat = bp::search_path("cat");
+    std::string head = bp::search_path("head");
+
+    std::cout << std::fixed << std::setprecision(0);
+    pipe_throughput(0, pipe_mb, head);
+    pipe_throughput(1 << 20, pipe_mb, head);
+
+    std::vector<config> configs;
+    config base = { rss_mb[0], fds[0], threads[0] };
+    if (vm.count("cross"))
+    {
+        for (std::size_t r = 0; r < rss_mb.size(); ++r)
+            for (std::size_t f = 0; f < fds.size(); ++f)
+                for (std::size_t t = 0; t < threads.size(); ++t)
+                {
+                    config c = { rss_mb[r], fds[f], threads[t] };
+                    configs.push_back(c);
+                }
+    }
+    else
+    {
+        configs.push_back(base);
+        for (std::size_t i = 1; i < rss_mb.size(); ++i)
+        {
+            config c = base;
+            c.rss_mb = rss_mb[i];
+            configs.push_back(c);
+        }
+        for (std::size_t i = 1; i < fds.size(); ++i)
+        {
+            config c = base;
+            c.fds = fds[i];
+            configs.push_back(c);
+        }
+        for (std::size_t i = 1; i < threads.size(); ++i)
+        {
+            config c = base;
+            c.threads = threads[i];
+            configs.push_back(c);
+        }
+    }
+
+    parent_state state;
+    for (std::size_t i = 0; i < configs.size(); ++i)
+    {
+        if (!state.apply(configs[i]))
+        {
+            std::cerr << "skipped rss_mb=" << configs[i].rss_mb << " fds=" <<
+                configs[i].fds << " threads=" << configs[i].threads << ": " <<
+                std::strerror(errno) << std::endl;
+            continue;
+        }
+        for (int b = backend_spawn; b <= backend_fork_server; ++b)
+        {
+            if (b == backend_fork_server && !server.running())
+                continue;
+            spawn_latency(static_cast<backend>(b), configs[i], iterations,
+                exe, server);
+            spawn_throughput(static_cast<backend>(b), configs[i],
+                iterations, exe, server);
+        }
+        wait_latency(configs[i], iterations, cat);
+    }
+}
@@ -8,11 +8,28 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <boost/process.hpp>
+#include <boost/process/posix/argv_builder.hpp>
+#include <boost/process/posix/async_run.hpp>
+#include <boost/process/posix/communicate.hpp>
+#include <boost/process/posix/environment.hpp>
+#include <boost/process/posix/execute_batch.hpp>
+#include <boost/process/posix/feed_stdin.hpp>
+#include <boost/process/posix/fork_server.hpp>
+#include <boost/process/posix/forward.hpp>
+#include <boost/process/posix/path_resolver.hpp>
+#include <boost/process/posix/pipeline.hpp>
+#include <boost/process/posix/sigchld_service.hpp>
+#include <boost/asio.hpp>
+#include <boost/chrono/duration.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <string>
 #include <iostream>
 #include <fstream>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
 
 using namespace boost::process;
@@ -29,6 +46,29 @@ int main()
     );
 //]
 
+    {
+//[bind_stdin_from_memory
+    std::string input(200 * 1024 * 1024, 'x');
+    child c = execute(
+        run_exe("/usr/bin/sort"),
+        bind_stdin_from_memory(boost::asio::buffer(input))
+    );
+    input.clear();
+//]
+    wait_for_exit(c);
+    }
+
+    {
+//[capture_stdout_to_memory
+    capture_stdout_to_memory output;
+    child c = execute(run_exe("/bin/ls"), output);
+    wait_for_exit(c);
+    boost::asio::const_buffer b = output.buffer();
+    std::cout.write(boost::asio::buffer_cast<const char*>(b),
+        boost::asio::buffer_size(b));
+//]
+    }
+
 //[close_fd
     execute(
         run_exe("test"),
@@ -50,6 +90,237 @@ int main()
     );
 //]
 
+//[close_all_fds_except
+    execute(
+        run_exe("test"),
+        close_all_fds_except(boost::assign::list_of(STDIN_FILENO)
+            (STDOUT_FILENO)(STDERR_FILENO))
+    );
+//]
+
+//[sigchld_service
+    boost::asio::io_service io_service;
+    posix::sigchld_service &service =
+        boost::asio::use_service<posix::sigchld_service>(io_service);
+
+    child c = execute(run_exe("test"));
+    service.async_wait(c.pid,
+        [](const boost::system::error_code&, int status)
+            { std::cout << WEXITSTATUS(status) << std::endl; });
+
+    io_service.run();
+//]
+
+    {
+//[wait_for_exit_info
+    child c = execute(run_exe("test"));
+    posix::exit_info info = posix::wait_for_exit_info(c);
+    std::cout << info.exit_code << ' ' << info.usage.ru_maxrss << std::endl;
+//]
+    }
+
+    {
+//[async_run
+    boost::asio::io_service io_service;
+    for (int i = 0; i < 100; ++i)
+    {
+        posix::async_run(io_service,
+            boost::fusion::make_vector(run_exe("/bin/echo"),
+                set_cmd_line("echo " + std::to_string(i))),
+            posix::capture_stdout | posix::capture_stderr,
+            [](const boost::system::error_code &ec,
+                const posix::run_result &r)
+            {
+                if (!ec)
+                    std::cout << r.info.exit_code << ' ' <<
+                        r.info.usage.ru_utime.tv_usec << ' ' <<
+                        boost::asio::buffer_size(r.out) << std::endl;
+            });
+    }
+    io_service.run();
+//]
+    }
+
+    {
+//[escalation
+    child c = execute(run_exe("test"));
+    int status = posix::terminate(c,
+        posix::escalation(boost::chrono::seconds(2)));
+//]
+    }
+
+    {
+//[new_process_group
+    child c = execute(run_exe("/bin/sh"), set_cmd_line("sh script.sh"),
+        new_process_group());
+    posix::terminate_group(c);
+    wait_for_exit(c);
+//]
+    }
+
+    {
+//[create_pipe_cloexec
+    boost::process::pipe p = create_pipe(O_CLOEXEC);
+    file_descriptor_sink sink(p.sink, close_handle);
+    execute(run_exe("test"), bind_stdout(sink));
+//]
+    }
+
+    {
+//[pipe_capacity
+    std::size_t capacity;
+    boost::process::pipe p = create_pipe(O_CLOEXEC, 1024 * 1024, capacity);
+    std::cout << capacity << std::endl;
+//]
+    }
+
+    {
+//[forward
+    boost::process::pipe p = create_pipe(O_CLOEXEC);
+    {
+        file_descriptor_sink sink(p.sink, close_handle);
+        execute(run_exe("test"), bind_stdout(sink));
+    }
+    int fd = ::open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    posix::forward(p.source, fd);
+//]
+    ::close(fd);
+    ::close(p.source);
+    }
+
+    {
+//[feed_stdin
+    std::string data(200 * 1024 * 1024, 'x');
+    boost::process::pipe p = create_pipe(O_CLOEXEC);
+    file_descriptor_source source(p.source, close_handle);
+    child c = execute(run_exe("/usr/bin/wc"), bind_stdin(source));
+    source.close();
+    posix::feed_stdin(p.sink, boost::asio::buffer(data));
+    ::close(p.sink);
+    wait_for_exit(c);
+//]
+    }
+
+    {
+//[communicate
+    boost::process::pipe in = create_pipe(O_CLOEXEC);
+    boost::process::pipe out = create_pipe(O_CLOEXEC);
+    boost::process::pipe err = create_pipe(O_CLOEXEC);
+    file_descriptor_source source(in.source, close_handle);
+    file_descriptor_sink out_sink(out.sink, close_handle);
+    file_descriptor_sink err_sink(err.sink, close_handle);
+    child c = execute(
+        run_exe("/usr/bin/sort"),
+        bind_stdin(source),
+        bind_stdout(out_sink),
+        bind_stderr(err_sink)
+    );
+    source.close();
+    out_sink.close();
+    err_sink.close();
+
+    std::string input(100 * 1024 * 1024, 'x');
+    std::string output, error;
+    int status = posix::communicate(c, in.sink, boost::asio::buffer(input),
+        out.source, output, err.source, error);
+//]
+    }
+
+    {
+//[pipeline
+    posix::pipeline p(true);
+    p.stage(run_exe("/bin/grep"), set_cmd_line("grep error log.txt"))
+     .stage(run_exe("/usr/bin/sort"), set_cmd_line("sort"))
+     .stage(run_exe("/usr/bin/uniq"), set_cmd_line("uniq -c"));
+    p.start();
+    std::vector<int> statuses = p.wait_for_exit();
+//]
+    }
+
+    {
+//[fork_server
+    posix::fork_server server;
+    server.start();
+
+    child c = execute(run_exe("test"), bind_stdout(sink), via(server));
+    wait_for_exit(c);
+//]
+    }
+
+    {
+//[execute_batch
+    std::vector<std::string> env = boost::assign::list_of("LANG=C");
+    posix::batch_result r = posix::execute_batch(10,
+        boost::fusion::make_vector(run_exe("worker"), set_env(env)),
+        [](std::size_t i)
+            { return set_cmd_line("worker --id " + std::to_string(i)); });
+
+    for (std::size_t i = 0; i < r.children.size(); ++i)
+    {
+        if (!r.errors[i])
+            wait_for_exit(r.children[i]);
+    }
+//]
+    }
+
+    {
+//[argv_builder
+    posix::argv_builder args;
+    for (int i = 0; i < 10; ++i)
+    {
+        args.clear();
+        args.arg("worker").arg("--id").arg(i);
+        wait_for_exit(execute(run_exe("worker"), set_args(args)));
+    }
+//]
+    }
+
+    {
+//[environment
+    posix::environment base = posix::environment::current();
+    for (int i = 0; i < 10; ++i)
+    {
+        posix::environment env = base;
+        env.set("WORKER_ID", std::to_string(i));
+        env.unset("DISPLAY");
+        wait_for_exit(execute(run_exe("worker"), set_env(env)));
+    }
+//]
+    }
+
+    {
+//[async_on_error
+    boost::asio::io_service io_service;
+    for (int i = 0; i < 10; ++i)
+    {
+        execute(
+            run_exe("worker"),
+            start_in_dir("/var/run/worker"),
+            async_on_error(io_service,
+                [](const boost::system::error_code &ec, posix::exec_stage s)
+                {
+                    if (ec)
+                        std::cerr << posix::exec_stage_name(s) << ": " <<
+                            ec.message() << std::endl;
+                })
+        );
+    }
+    io_service.run();
+//]
+    }
+
+    {
+//[path_resolver
+    posix::path_resolver resolver;
+    for (int i = 0; i < 3; ++i)
+    {
+        std::string exe = resolver.search_path("ls");
+        if (!exe.empty())
+            wait_for_exit(execute(run_exe(exe)));
+    }
+//]
+    }
+
 //[fork_execve
     const char *env[2] = { 0 };
     env[0] = "LANG=de";
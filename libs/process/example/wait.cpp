@@ -9,12 +9,7 @@
 
 #include <boost/process.hpp>
 #include <boost/asio.hpp>
-#if defined(BOOST_WINDOWS_API)
-#   include <Windows.h>
-#elif defined(BOOST_POSIX_API)
-#   include <sys/wait.h>
-#   include <errno.h>
-#endif
+#include <boost/chrono/duration.hpp>
 
 using namespace boost::process;
 using namespace boost::process::initializers;
@@ -28,33 +23,23 @@ int main()
 //]
     }
 
+    {
+//[timed
+    child c = execute(run_exe("test.exe"));
+    auto exit_code = wait_for_exit_for(c, boost::chrono::seconds(5));
+    if (!exit_code)
+        terminate(c);
+//]
+    }
+
     {
 //[async
     boost::asio::io_service io_service;
 
-#if defined(BOOST_POSIX_API)
-    int status;
-    boost::asio::signal_set set(io_service, SIGCHLD);
-    set.async_wait(
-        [&status](const boost::system::error_code&, int) { ::wait(&status); }
-    );
-#endif
-
-    child c = execute(
-        run_exe("test.exe")
-#if defined(BOOST_POSIX_API)
-        , notify_io_service(io_service)
-#endif
-    );
-
-#if defined(BOOST_WINDOWS_API)
-    DWORD exit_code;
-    boost::asio::windows::object_handle handle(io_service, c.process_handle());
-    handle.async_wait(
-        [&handle, &exit_code](const boost::system::error_code&)
-            { ::GetExitCodeProcess(handle.native(), &exit_code); }
-    );
-#endif
+    child c = execute(run_exe("test.exe"));
+
+    async_wait_for_exit(io_service, c,
+        [](const boost::system::error_code&, int) {});
 
     io_service.run();
 //]
@@ -11,18 +11,46 @@
 #define BOOST_TEST_IGNORE_SIGCHLD
 #include <boost/test/included/unit_test.hpp>
 #include <boost/process.hpp>
+#include <boost/process/posix/argv_builder.hpp>
+#include <boost/process/posix/async_run.hpp>
+#include <boost/process/posix/communicate.hpp>
+#include <boost/process/posix/environment.hpp>
+#include <boost/process/posix/execute_batch.hpp>
+#include <boost/process/posix/feed_stdin.hpp>
+#include <boost/process/posix/forward.hpp>
+#include <boost/process/posix/path_resolver.hpp>
+#include <boost/process/posix/pipeline.hpp>
+#include <boost/process/posix/sigchld_service.hpp>
+#include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/system/system_error.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream.hpp>
+#include <boost/lambda/lambda.hpp>
+#include <boost/assign/list_of.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/chrono/duration.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <pthread.h>
 #include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
 
 namespace bp = boost::process;
 namespace bpi = boost::process::initializers;
 namespace bio = boost::iostreams;
 
+void nop(bp::executor&) {}
+
 BOOST_AUTO_TEST_CASE(bind_fd)
 {
     using boost::unit_test::framework::master_test_suite;
@@ -85,6 +113,320 @@ BOOST_AUTO_TEST_CASE(bind_fds)
     BOOST_CHECK_EQUAL(s2, "bye");
 }
 
+BOOST_AUTO_TEST_CASE(bind_fd_close_fds_if)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe();
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --posix-echo-one 99 hello"),
+            bpi::bind_fd(99, sink),
+            bpi::close_fds_if(boost::lambda::_1 == p.source),
+            bpi::set_on_error(ec)
+        );
+        BOOST_CHECK(!ec);
+    }
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+
+    std::string s;
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "hello");
+}
+
+BOOST_AUTO_TEST_CASE(close_fds_if_before_bind_stdout)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe();
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout hello"),
+            bpi::close_fds_if(boost::lambda::_1 > 2),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_CHECK(!ec);
+    }
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+
+    std::string s;
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "hello");
+}
+
+BOOST_AUTO_TEST_CASE(close_all_fds_except)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe();
+    bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_args(boost::assign::list_of<std::string>("test")
+            ("--posix-is-closed-fd")
+            (boost::lexical_cast<std::string>(p.sink))),
+        bpi::close_all_fds_except(boost::assign::list_of(STDIN_FILENO)
+            (STDOUT_FILENO)(STDERR_FILENO)),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+}
+
+BOOST_AUTO_TEST_CASE(close_all_fds_except_fork)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe();
+    bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_args(boost::assign::list_of<std::string>("test")
+            ("--posix-is-closed-fd")
+            (boost::lexical_cast<std::string>(p.sink))),
+        bpi::close_all_fds_except(boost::assign::list_of(STDIN_FILENO)
+            (STDOUT_FILENO)(STDERR_FILENO)),
+        bpi::on_exec_setup(nop),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+}
+
+// Opens a file descriptor which is only open in the child process, like a
+// file descriptor the parent closes after fork.
+void dup_stderr_to_30(bp::posix::executor&)
+{
+    ::dup2(STDERR_FILENO, 30);
+}
+
+BOOST_AUTO_TEST_CASE(close_fds_if_child_fds)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --posix-is-closed-fd 30"),
+        bpi::on_exec_setup(dup_stderr_to_30),
+        bpi::close_fds_if(boost::lambda::_1 == 30),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+}
+
+struct exit_code_handler
+{
+    int &exit_code_;
+
+    exit_code_handler(int &exit_code) : exit_code_(exit_code) {}
+
+    void operator()(const boost::system::error_code &ec, int status)
+    {
+        BOOST_REQUIRE(!ec);
+        exit_code_ = WEXITSTATUS(status);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(sigchld_service)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    bp::posix::sigchld_service &service =
+        boost::asio::use_service<bp::posix::sigchld_service>(io_service);
+
+    int exit_codes[3] = { 0 };
+    for (int i = 0; i < 3; ++i)
+    {
+        boost::system::error_code ec;
+        bp::child c = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_args(boost::assign::list_of<std::string>("test")
+                ("--exit-code")(boost::lexical_cast<std::string>(i + 1))),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+        service.async_wait(c.pid, exit_code_handler(exit_codes[i]));
+    }
+
+    io_service.run();
+    BOOST_CHECK_EQUAL(1, exit_codes[0]);
+    BOOST_CHECK_EQUAL(2, exit_codes[1]);
+    BOOST_CHECK_EQUAL(3, exit_codes[2]);
+}
+
+struct counting_exit_handler
+{
+    int &calls_;
+    int &exit_code_;
+
+    counting_exit_handler(int &calls, int &exit_code)
+        : calls_(calls), exit_code_(exit_code) {}
+
+    void operator()(const boost::system::error_code &ec, int status)
+    {
+        BOOST_REQUIRE(!ec);
+        ++calls_;
+        exit_code_ = WEXITSTATUS(status);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(sigchld_service_many)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    bp::posix::sigchld_service &service =
+        boost::asio::use_service<bp::posix::sigchld_service>(io_service);
+
+    // Many children exit while others are still being registered.
+    const int count = 200;
+    std::vector<int> calls(count, 0);
+    std::vector<int> exit_codes(count, -1);
+    for (int i = 0; i < count; ++i)
+    {
+        bp::child c = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_args(boost::assign::list_of<std::string>("test")
+                ("--exit-code")(boost::lexical_cast<std::string>(i % 100))),
+            bpi::throw_on_error()
+        );
+        service.async_wait(c.pid,
+            counting_exit_handler(calls[i], exit_codes[i]));
+    }
+
+    io_service.run();
+    for (int i = 0; i < count; ++i)
+    {
+        BOOST_CHECK_EQUAL(1, calls[i]);
+        BOOST_CHECK_EQUAL(i % 100, exit_codes[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sigchld_service_unregistered_child)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::child other = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 5"),
+        bpi::throw_on_error()
+    );
+    siginfo_t info;
+    BOOST_REQUIRE_EQUAL(0, ::waitid(P_PID, other.pid, &info,
+        WEXITED | WNOWAIT));
+
+    boost::asio::io_service io_service;
+    bp::posix::sigchld_service &service =
+        boost::asio::use_service<bp::posix::sigchld_service>(io_service);
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 1"),
+        bpi::throw_on_error()
+    );
+    int exit_code = 0;
+    service.async_wait(c.pid, exit_code_handler(exit_code));
+    io_service.run();
+    BOOST_CHECK_EQUAL(1, exit_code);
+
+    // The service didn't reap the child it wasn't asked to wait for.
+    BOOST_CHECK_EQUAL(5, WEXITSTATUS(bp::wait_for_exit(other)));
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_exit_info)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 3"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    bp::posix::exit_info info = bp::posix::wait_for_exit_info(c);
+    BOOST_CHECK_EQUAL(3, info.exit_code);
+    BOOST_CHECK_EQUAL(0, info.signal);
+    BOOST_CHECK(info.usage.ru_maxrss > 0);
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_exit_info_signal)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    bp::terminate(c);
+    bp::posix::exit_info info = bp::posix::wait_for_exit_info(c, ec);
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(-1, info.exit_code);
+    BOOST_CHECK_EQUAL(SIGKILL, info.signal);
+}
+
+struct exit_info_handler
+{
+    bp::posix::exit_info &info_;
+
+    exit_info_handler(bp::posix::exit_info &info) : info_(info) {}
+
+    void operator()(const boost::system::error_code &ec,
+        const bp::posix::exit_info &info)
+    {
+        BOOST_REQUIRE(!ec);
+        info_ = info;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_wait_for_exit_info)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 4"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    boost::asio::io_service io_service;
+    bp::posix::exit_info info;
+    bp::posix::async_wait_for_exit_info(io_service, c,
+        exit_info_handler(info));
+    io_service.run();
+
+    BOOST_CHECK_EQUAL(4, info.exit_code);
+    BOOST_CHECK(info.usage.ru_maxrss > 0);
+}
+
 BOOST_AUTO_TEST_CASE(execve_set_on_error)
 {
     boost::system::error_code ec;
@@ -96,6 +438,76 @@ BOOST_AUTO_TEST_CASE(execve_set_on_error)
     BOOST_CHECK_EQUAL(ec.value(), ENOENT);
 }
 
+BOOST_AUTO_TEST_CASE(execve_set_on_error_fork)
+{
+    boost::system::error_code ec;
+    bp::execute(
+        bpi::run_exe("doesnt-exist"),
+        bpi::on_exec_setup(nop),
+        bpi::set_on_error(ec)
+    );
+    BOOST_CHECK(ec);
+    BOOST_CHECK_EQUAL(ec.value(), ENOENT);
+}
+
+struct dup_fd
+{
+    int fd_;
+    int id_;
+
+    dup_fd(int fd, int id) : fd_(fd), id_(id) {}
+
+    void operator()(bp::executor&) const
+    {
+        ::dup2(fd_, id_);
+    }
+};
+
+namespace boost { namespace process { namespace posix { namespace initializers {
+
+template <>
+struct is_vfork_safe<dup_fd> : boost::true_type {};
+
+}}}}
+
+BOOST_AUTO_TEST_CASE(vfork_safe_on_exec_setup)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe();
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --posix-echo-one 3 hello"),
+            bpi::on_exec_setup(dup_fd(p.sink, 3)),
+            bpi::set_on_error(ec)
+        );
+        BOOST_CHECK(!ec);
+    }
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+
+    std::string s;
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "hello");
+}
+
+BOOST_AUTO_TEST_CASE(execve_set_on_error_vfork)
+{
+    boost::system::error_code ec;
+    bp::execute(
+        bpi::run_exe("doesnt-exist"),
+        bpi::on_exec_setup(dup_fd(STDOUT_FILENO, STDOUT_FILENO)),
+        bpi::set_on_error(ec)
+    );
+    BOOST_CHECK(ec);
+    BOOST_CHECK_EQUAL(ec.value(), ENOENT);
+}
+
 BOOST_AUTO_TEST_CASE(execve_throw_on_error)
 {
     try
@@ -111,3 +523,1610 @@ BOOST_AUTO_TEST_CASE(execve_throw_on_error)
         BOOST_CHECK_EQUAL(e.code().value(), ENOENT);
     }
 }
+
+BOOST_AUTO_TEST_CASE(terminate_escalation)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    int status = bp::posix::terminate(c,
+        bp::posix::escalation(boost::chrono::seconds(10)));
+    BOOST_REQUIRE(WIFSIGNALED(status));
+    BOOST_CHECK_EQUAL(SIGTERM, WTERMSIG(status));
+}
+
+BOOST_AUTO_TEST_CASE(terminate_escalation_final_signal)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    int status = bp::posix::terminate(c,
+        bp::posix::escalation(boost::chrono::milliseconds(50), 0), ec);
+    BOOST_REQUIRE(!ec);
+    BOOST_REQUIRE(WIFSIGNALED(status));
+    BOOST_CHECK_EQUAL(SIGKILL, WTERMSIG(status));
+}
+
+BOOST_AUTO_TEST_CASE(new_process_group)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::new_process_group(),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(c.pid, ::getpgid(c.pid));
+
+    bp::posix::terminate_group(c, ec);
+    BOOST_REQUIRE(!ec);
+    int status = bp::wait_for_exit(c, ec);
+    BOOST_REQUIRE(WIFSIGNALED(status));
+    BOOST_CHECK_EQUAL(SIGKILL, WTERMSIG(status));
+}
+
+BOOST_AUTO_TEST_CASE(new_process_group_fork)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::new_process_group(),
+        bpi::on_exec_setup(nop),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(c.pid, ::getpgid(c.pid));
+
+    BOOST_CHECK_NO_THROW(bp::posix::terminate_group(c));
+    bp::wait_for_exit(c, ec);
+}
+
+BOOST_AUTO_TEST_CASE(new_session)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::new_session(),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    bp::posix::wait_for_exit_for(c, boost::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(c.pid, ::getsid(c.pid));
+
+    bp::posix::terminate_group(c, ec);
+    BOOST_REQUIRE(!ec);
+    bp::wait_for_exit(c, ec);
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_exit_for_without_pidfd)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    sigset_t set, old;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    BOOST_REQUIRE_EQUAL(0, ::pthread_sigmask(SIG_BLOCK, &set, &old));
+
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 4"),
+        bpi::throw_on_error()
+    );
+    bp::child without_pidfd(c.pid);
+    boost::optional<int> status = bp::posix::wait_for_exit_for(
+        without_pidfd, boost::chrono::seconds(10));
+    BOOST_REQUIRE(status);
+    BOOST_CHECK_EQUAL(4, WEXITSTATUS(*status));
+
+    // SIGCHLD is left for other handlers.
+    sigset_t pending;
+    sigemptyset(&pending);
+    ::sigpending(&pending);
+    BOOST_CHECK(sigismember(&pending, SIGCHLD));
+    int sig;
+    if (sigismember(&pending, SIGCHLD))
+        ::sigwait(&set, &sig);
+    ::pthread_sigmask(SIG_SETMASK, &old, 0);
+}
+
+BOOST_AUTO_TEST_CASE(terminate_group_not_leader)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --loop"),
+        bpi::throw_on_error()
+    );
+
+    boost::system::error_code ec;
+    bp::posix::terminate_group(c, ec);
+    BOOST_CHECK_EQUAL(EINVAL, ec.value());
+
+    bp::terminate(c);
+    bp::wait_for_exit(c, ec);
+}
+
+BOOST_AUTO_TEST_CASE(create_pipe_cloexec)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    BOOST_CHECK(::fcntl(p.source, F_GETFD) & FD_CLOEXEC);
+    BOOST_CHECK(::fcntl(p.sink, F_GETFD) & FD_CLOEXEC);
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::child c = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --posix-is-closed-fd " +
+                boost::lexical_cast<std::string>(p.source)),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+        int status = bp::wait_for_exit(c);
+        BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+    }
+
+    char buffer[1];
+    BOOST_CHECK_EQUAL(0, ::read(p.source, buffer, sizeof(buffer)));
+    ::close(p.source);
+}
+
+BOOST_AUTO_TEST_CASE(bind_fd_same_fd_cloexec)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    BOOST_REQUIRE_EQUAL(99, ::dup3(p.sink, 99, O_CLOEXEC));
+    ::close(p.sink);
+
+    {
+        bio::file_descriptor_sink sink(99, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --posix-echo-one 99 hello"),
+            bpi::bind_fd(99, sink),
+            bpi::on_exec_setup(nop),
+            bpi::set_on_error(ec)
+        );
+        BOOST_CHECK(!ec);
+    }
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+
+    std::string s;
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "hello");
+}
+
+BOOST_AUTO_TEST_CASE(pipe_capacity)
+{
+    bp::pipe p = bp::create_pipe(O_CLOEXEC, 256 * 1024);
+    std::size_t capacity = bp::posix::pipe_capacity(p.source);
+    BOOST_CHECK_EQUAL(capacity, bp::posix::pipe_capacity(p.sink));
+    BOOST_CHECK(capacity >= 4096);
+
+    BOOST_CHECK_EQUAL(4096u, bp::posix::set_pipe_capacity(p.sink, 4096));
+    BOOST_CHECK_EQUAL(4096u, bp::posix::pipe_capacity(p.source));
+
+    boost::system::error_code ec;
+    capacity = bp::posix::set_pipe_capacity(p.source, ~std::size_t(0), ec);
+    BOOST_CHECK(!ec);
+    BOOST_CHECK(capacity >= 4096);
+
+    ::close(p.source);
+    ::close(p.sink);
+
+    p = bp::create_pipe(O_CLOEXEC, 128 * 1024, capacity);
+    BOOST_CHECK_EQUAL(capacity, bp::posix::pipe_capacity(p.source));
+    BOOST_CHECK(capacity >= 4096);
+    ::close(p.source);
+    ::close(p.sink);
+
+    p = bp::create_pipe(O_CLOEXEC, 8192, capacity, ec);
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL(8192u, capacity);
+    BOOST_CHECK_EQUAL(8192u, bp::posix::pipe_capacity(p.sink));
+    ::close(p.source);
+    ::close(p.sink);
+}
+
+std::string read_file(int fd)
+{
+    std::string s;
+    char buffer[256];
+    ssize_t n;
+    ::lseek(fd, 0, SEEK_SET);
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+        s.append(buffer, n);
+    return s;
+}
+
+BOOST_AUTO_TEST_CASE(forward)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout hello"),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+    }
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    BOOST_CHECK_EQUAL(6u, bp::posix::forward(p.source, ::fileno(file)));
+    BOOST_CHECK_EQUAL("hello\n", read_file(::fileno(file)));
+    std::fclose(file);
+    ::close(p.source);
+}
+
+BOOST_AUTO_TEST_CASE(forward_read_write)
+{
+    FILE *source = std::tmpfile();
+    FILE *sink = std::tmpfile();
+    BOOST_REQUIRE(source && sink);
+    BOOST_REQUIRE_EQUAL(5, ::write(::fileno(source), "hello", 5));
+    ::lseek(::fileno(source), 0, SEEK_SET);
+
+    boost::system::error_code ec;
+    BOOST_CHECK_EQUAL(5u,
+        bp::posix::forward(::fileno(source), ::fileno(sink), ec));
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(sink)));
+    std::fclose(source);
+    std::fclose(sink);
+}
+
+BOOST_AUTO_TEST_CASE(forward_tee)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    bp::pipe copy = bp::create_pipe(O_CLOEXEC);
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout hello"),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+    }
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    BOOST_CHECK_EQUAL(6u,
+        bp::posix::forward(p.source, ::fileno(file), copy.sink));
+    BOOST_CHECK_EQUAL("hello\n", read_file(::fileno(file)));
+    ::close(copy.sink);
+    BOOST_CHECK_EQUAL("hello\n", read_file(copy.source));
+    std::fclose(file);
+    ::close(p.source);
+    ::close(copy.source);
+}
+
+BOOST_AUTO_TEST_CASE(forward_tee_read_write)
+{
+    FILE *source = std::tmpfile();
+    FILE *sink = std::tmpfile();
+    FILE *copy = std::tmpfile();
+    BOOST_REQUIRE(source && sink && copy);
+    BOOST_REQUIRE_EQUAL(5, ::write(::fileno(source), "hello", 5));
+    ::lseek(::fileno(source), 0, SEEK_SET);
+
+    boost::system::error_code ec;
+    BOOST_CHECK_EQUAL(5u, bp::posix::forward(::fileno(source),
+        ::fileno(sink), ::fileno(copy), ec));
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(sink)));
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(copy)));
+    std::fclose(source);
+    std::fclose(sink);
+    std::fclose(copy);
+}
+
+struct forward_handler
+{
+    std::size_t &total_;
+
+    forward_handler(std::size_t &total) : total_(total) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t total)
+    {
+        BOOST_REQUIRE(!ec);
+        total_ = total;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_forward)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout hello"),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+    }
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+
+    boost::asio::io_service io_service;
+    std::size_t total = 0;
+    bp::posix::async_forward(io_service, p.source, ::fileno(file),
+        forward_handler(total));
+    io_service.run();
+
+    BOOST_CHECK_EQUAL(6u, total);
+    BOOST_CHECK_EQUAL("hello\n", read_file(::fileno(file)));
+    std::fclose(file);
+    ::close(p.source);
+}
+
+BOOST_AUTO_TEST_CASE(pipeline)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    boost::system::error_code ec;
+    bp::posix::pipeline pl(true);
+
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        pl.stage(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout hello"),
+            bpi::set_on_error(ec)
+        ).stage(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --stdin-to-stdout"),
+            bpi::on_exec_setup(nop),
+            bpi::set_on_error(ec)
+        ).stage(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --stdin-to-stdout"),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        pl.start();
+    }
+    BOOST_REQUIRE(!ec);
+    BOOST_REQUIRE_EQUAL(3u, pl.size());
+    for (std::size_t i = 0; i < pl.size(); ++i)
+        BOOST_CHECK_EQUAL(pl.process_group(), ::getpgid(pl[i].pid));
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+
+    std::string s;
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "hello");
+
+    std::vector<int> statuses = pl.wait_for_exit();
+    BOOST_REQUIRE_EQUAL(3u, statuses.size());
+    for (std::size_t i = 0; i < statuses.size(); ++i)
+        BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(statuses[i]));
+}
+
+BOOST_AUTO_TEST_CASE(pipeline_first_stage_error)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::posix::pipeline pl(true);
+    pl.stage(
+        bpi::run_exe("doesnt-exist"),
+        bpi::set_on_error(ec)
+    ).stage(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --stdin-to-stdout"),
+        bpi::throw_on_error()
+    );
+    pl.start();
+    BOOST_CHECK(ec);
+    BOOST_CHECK_EQUAL(0, pl.failed_stage());
+    BOOST_REQUIRE_EQUAL(1u, pl.size());
+    BOOST_CHECK_EQUAL(-1, pl[0].pid);
+
+    // A second run doesn't keep the children of the first one.
+    pl.stage(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 3"),
+        bpi::throw_on_error()
+    );
+    pl.start();
+    BOOST_CHECK_EQUAL(-1, pl.failed_stage());
+    BOOST_REQUIRE_EQUAL(1u, pl.size());
+    std::vector<int> statuses = pl.wait_for_exit();
+    BOOST_CHECK_EQUAL(3, WEXITSTATUS(statuses[0]));
+}
+
+BOOST_AUTO_TEST_CASE(pipeline_pipe_error)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::pipeline pl;
+    pl.stage(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --echo-stdout hello"),
+        bpi::throw_on_error()
+    ).stage(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --stdin-to-stdout"),
+        bpi::throw_on_error()
+    );
+
+    // All file descriptors below the lowest free one are in use, so the
+    // first pipe fails with EMFILE.
+    int lowest = ::dup(STDIN_FILENO);
+    BOOST_REQUIRE(lowest != -1);
+    ::close(lowest);
+    rlimit old;
+    BOOST_REQUIRE_EQUAL(0, ::getrlimit(RLIMIT_NOFILE, &old));
+    rlimit limit = old;
+    limit.rlim_cur = lowest;
+    BOOST_REQUIRE_EQUAL(0, ::setrlimit(RLIMIT_NOFILE, &limit));
+
+    boost::system::error_code ec;
+    pl.start(ec);
+    std::string what;
+    try
+    {
+        bp::posix::pipeline thrower;
+        thrower.stage(bpi::run_exe(master_test_suite().argv[1])).stage(
+            bpi::run_exe(master_test_suite().argv[1]));
+        thrower.start();
+    }
+    catch (boost::system::system_error &e)
+    {
+        what = e.what();
+    }
+    ::setrlimit(RLIMIT_NOFILE, &old);
+
+    BOOST_CHECK(what.find("between stages 0 and 1") != std::string::npos);
+    BOOST_CHECK_EQUAL(EMFILE, ec.value());
+    BOOST_CHECK_EQUAL(0, pl.failed_stage());
+    BOOST_CHECK_EQUAL(0u, pl.size());
+}
+
+BOOST_AUTO_TEST_CASE(fork_server)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::fork_server server;
+    server.start();
+    BOOST_REQUIRE(server.running());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        bp::pipe p = bp::create_pipe(O_CLOEXEC);
+
+        {
+            bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+            boost::system::error_code ec;
+            bp::child c = bp::execute(
+                bpi::run_exe(master_test_suite().argv[1]),
+                bpi::set_cmd_line("test --echo-stdout hello"),
+                bpi::bind_stdout(sink),
+                bpi::via(server),
+                bpi::set_on_error(ec)
+            );
+            BOOST_REQUIRE(!ec);
+            int status = bp::wait_for_exit(c);
+            BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+        }
+
+        bio::file_descriptor_source source(p.source, bio::close_handle);
+        bio::stream<bio::file_descriptor_source> is(source);
+
+        std::string s;
+        is >> s;
+        BOOST_CHECK_EQUAL(s, "hello");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fork_server_set_on_error)
+{
+    bp::posix::fork_server server;
+    server.start();
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe("doesnt-exist"),
+        bpi::via(server),
+        bpi::set_on_error(ec)
+    );
+    BOOST_CHECK_EQUAL(-1, c.pid);
+    BOOST_CHECK(ec);
+}
+
+struct exit_code_cmd_line
+{
+    bpi::set_cmd_line operator()(std::size_t i) const
+    {
+        return bpi::set_cmd_line("test --exit-code " +
+            boost::lexical_cast<std::string>(i));
+    }
+};
+
+BOOST_AUTO_TEST_CASE(execute_batch)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::batch_result r = bp::posix::execute_batch(5,
+        boost::fusion::make_vector(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::inherit_env()
+        ),
+        exit_code_cmd_line());
+
+    BOOST_REQUIRE_EQUAL(5u, r.children.size());
+    BOOST_REQUIRE_EQUAL(5u, r.errors.size());
+    for (std::size_t i = 0; i < r.children.size(); ++i)
+    {
+        BOOST_REQUIRE(!r.errors[i]);
+        int status = bp::wait_for_exit(r.children[i]);
+        BOOST_CHECK_EQUAL(static_cast<int>(i), WEXITSTATUS(status));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(execute_batch_errors)
+{
+    bp::posix::batch_result r = bp::posix::execute_batch(2,
+        boost::fusion::make_vector(bpi::run_exe("doesnt-exist")),
+        exit_code_cmd_line());
+
+    BOOST_REQUIRE_EQUAL(2u, r.errors.size());
+    BOOST_CHECK(r.errors[0]);
+    BOOST_CHECK(r.errors[1]);
+}
+
+BOOST_AUTO_TEST_CASE(execute_batch_errors_fork)
+{
+    // execve fails after fork. The children are reaped by execute_batch.
+    bp::posix::batch_result r = bp::posix::execute_batch(2,
+        boost::fusion::make_vector(
+            bpi::run_exe("doesnt-exist"),
+            bpi::on_exec_setup(nop)
+        ),
+        exit_code_cmd_line());
+
+    BOOST_REQUIRE_EQUAL(2u, r.errors.size());
+    for (std::size_t i = 0; i < r.errors.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(ENOENT, r.errors[i].value());
+        BOOST_CHECK_EQUAL(-1, r.children[i].pid);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(path_resolver)
+{
+    bp::posix::path_resolver resolver;
+
+    std::string path = "/usr/local/bin:/usr/bin:/bin";
+    BOOST_CHECK_EQUAL(bp::search_path("ls", path),
+        resolver.search_path("ls", path));
+    BOOST_CHECK_EQUAL(bp::search_path("ls", path),
+        resolver.search_path("ls", path));
+
+    char dir[] = "/tmp/path_resolverXXXXXX";
+    BOOST_REQUIRE(::mkdtemp(dir));
+    std::string tool = std::string(dir) + "/tool";
+
+    BOOST_CHECK(resolver.search_path("tool", dir).empty());
+    BOOST_CHECK(resolver.search_path("tool", dir).empty());
+
+    int fd = ::open(tool.c_str(), O_CREAT | O_WRONLY, 0755);
+    BOOST_REQUIRE(fd != -1);
+    ::close(fd);
+    BOOST_CHECK_EQUAL(tool, resolver.search_path("tool", dir));
+
+    ::unlink(tool.c_str());
+    BOOST_CHECK(resolver.search_path("tool", dir).empty());
+
+    ::rmdir(dir);
+}
+
+BOOST_AUTO_TEST_CASE(argv_builder)
+{
+    char buffer[64];
+    bp::posix::argv_builder args(buffer, sizeof(buffer));
+    args.arg("test").arg(std::string("--exit-code")).arg(-42);
+    BOOST_REQUIRE_EQUAL(3u, args.size());
+    BOOST_CHECK_EQUAL(std::string("test"), args[0]);
+    BOOST_CHECK_EQUAL(std::string("--exit-code"), args[1]);
+    BOOST_CHECK_EQUAL(std::string("-42"), args[2]);
+    BOOST_CHECK(!args.argv()[3]);
+
+    // Outgrows the caller-supplied buffer.
+    std::string long_arg(100, 'x');
+    args.arg(boost::string_ref(long_arg)).arg(18446744073709551615ull);
+    BOOST_REQUIRE_EQUAL(5u, args.size());
+    BOOST_CHECK_EQUAL(std::string("test"), args[0]);
+    BOOST_CHECK_EQUAL(long_arg, args[3]);
+    BOOST_CHECK_EQUAL(std::string("18446744073709551615"), args[4]);
+    BOOST_CHECK(!args.argv()[5]);
+
+    bp::posix::argv_builder copy(args);
+    args.clear();
+    BOOST_CHECK(args.empty());
+    BOOST_CHECK(!args.argv()[0]);
+    BOOST_REQUIRE_EQUAL(5u, copy.size());
+    BOOST_CHECK_EQUAL(long_arg, copy[3]);
+
+    // Appends arguments of the builder itself while it grows.
+    for (int i = 0; i < 8; ++i)
+        copy.arg(copy[3]);
+    BOOST_REQUIRE_EQUAL(13u, copy.size());
+    for (std::size_t i = 5; i < copy.size(); ++i)
+        BOOST_CHECK_EQUAL(long_arg, copy[i]);
+}
+
+BOOST_AUTO_TEST_CASE(set_args_argv_builder)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::argv_builder args;
+    for (int i = 0; i < 3; ++i)
+    {
+        args.clear();
+        args.arg("test").arg("--exit-code").arg(i);
+
+        boost::system::error_code ec;
+        bp::child c = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_args(args),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+        BOOST_CHECK_EQUAL(i, WEXITSTATUS(bp::wait_for_exit(c)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(environment)
+{
+    const char *vars[] = { "FOO=1", "BAR=2", "BAZ=3", 0 };
+    bp::posix::environment base(const_cast<char**>(vars));
+    BOOST_CHECK_EQUAL("2", *base.get("BAR"));
+    BOOST_CHECK(!base.get("QUX"));
+
+    bp::posix::environment env = base;
+    env.set("BAR", "two");
+    env.set("QUX", "4");
+    env.unset("FOO");
+    BOOST_CHECK_EQUAL("two", *env.get("BAR"));
+    BOOST_CHECK_EQUAL("4", *env.get("QUX"));
+    BOOST_CHECK(!env.has("FOO"));
+
+    char **envp = env.envp();
+    BOOST_CHECK_EQUAL(std::string("BAR=two"), envp[0]);
+    BOOST_CHECK_EQUAL(std::string("BAZ=3"), envp[1]);
+    BOOST_CHECK_EQUAL(std::string("QUX=4"), envp[2]);
+    BOOST_CHECK(!envp[3]);
+    BOOST_CHECK_EQUAL(envp, env.envp());
+
+    envp = base.envp();
+    BOOST_CHECK_EQUAL(std::string("FOO=1"), envp[0]);
+    BOOST_CHECK_EQUAL(std::string("BAR=2"), envp[1]);
+    BOOST_CHECK_EQUAL(std::string("BAZ=3"), envp[2]);
+    BOOST_CHECK(!envp[3]);
+}
+
+BOOST_AUTO_TEST_CASE(set_env_environment)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::environment env = bp::posix::environment::current();
+    env.set("BOOST_PROCESS_TEST", "42");
+
+    bp::pipe p = bp::create_pipe();
+    {
+        bio::file_descriptor_sink sink(p.sink, bio::close_handle);
+        boost::system::error_code ec;
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --query BOOST_PROCESS_TEST"),
+            bpi::set_env(env),
+            bpi::bind_stdout(sink),
+            bpi::set_on_error(ec)
+        );
+        BOOST_REQUIRE(!ec);
+    }
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::stream<bio::file_descriptor_source> is(source);
+    std::string s;
+    std::getline(is, s);
+    BOOST_CHECK_EQUAL("defined", s);
+    std::getline(is, s);
+    BOOST_CHECK_EQUAL("42", s);
+}
+
+struct exec_error_handler
+{
+    boost::system::error_code &ec_;
+    bp::posix::exec_stage &stage_;
+
+    exec_error_handler(boost::system::error_code &ec,
+        bp::posix::exec_stage &stage) : ec_(ec), stage_(stage) {}
+
+    void operator()(const boost::system::error_code &ec,
+        bp::posix::exec_stage stage) const
+    {
+        ec_ = ec;
+        stage_ = stage;
+    }
+};
+
+void no_op(bp::posix::executor&) {}
+
+BOOST_AUTO_TEST_CASE(async_on_error)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    boost::system::error_code ec = boost::asio::error::would_block;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_execve;
+
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 0"),
+        bpi::on_exec_setup(no_op),
+        bpi::async_on_error(io_service, exec_error_handler(ec, stage))
+    );
+    io_service.run();
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_none, stage);
+    BOOST_CHECK_EQUAL(0, WEXITSTATUS(bp::wait_for_exit(c)));
+}
+
+BOOST_AUTO_TEST_CASE(async_on_error_execve)
+{
+    boost::asio::io_service io_service;
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+
+    bp::child c = bp::execute(
+        bpi::run_exe("doesnt-exist"),
+        bpi::on_exec_setup(no_op),
+        bpi::async_on_error(io_service, exec_error_handler(ec, stage))
+    );
+    io_service.run();
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_execve, stage);
+    bp::wait_for_exit(c);
+}
+
+BOOST_AUTO_TEST_CASE(async_on_error_chdir)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::start_in_dir("/doesnt-exist"),
+        bpi::on_exec_setup(no_op),
+        bpi::async_on_error(io_service, exec_error_handler(ec, stage))
+    );
+    io_service.run();
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_chdir, stage);
+    bp::wait_for_exit(c);
+}
+
+BOOST_AUTO_TEST_CASE(async_on_error_chdir_spawn)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::start_in_dir("/doesnt-exist"),
+        bpi::async_on_error(io_service, exec_error_handler(ec, stage))
+    );
+    io_service.run();
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+#if defined(BOOST_PROCESS_POSIX_HAS_SPAWN_ADDCHDIR)
+    BOOST_CHECK_EQUAL(-1, c.pid);
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_spawn, stage);
+#else
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_chdir, stage);
+    bp::wait_for_exit(c);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(async_on_error_spawn)
+{
+    boost::asio::io_service io_service;
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+
+    bp::child c = bp::execute(
+        bpi::run_exe("doesnt-exist"),
+        bpi::async_on_error(io_service, exec_error_handler(ec, stage))
+    );
+    io_service.run();
+    BOOST_CHECK(ec);
+    BOOST_CHECK_EQUAL(-1, c.pid);
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_spawn, stage);
+}
+
+struct counting_exec_error_handler
+{
+    int &calls_;
+    boost::system::error_code &ec_;
+
+    counting_exec_error_handler(int &calls, boost::system::error_code &ec)
+        : calls_(calls), ec_(ec) {}
+
+    void operator()(const boost::system::error_code &ec,
+        bp::posix::exec_stage) const
+    {
+        ++calls_;
+        ec_ = ec;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_on_error_fork)
+{
+    boost::asio::io_service io_service;
+    boost::system::error_code ec;
+    int calls = 0;
+    bpi::async_on_error_<counting_exec_error_handler> init(io_service,
+        counting_exec_error_handler(calls, ec));
+
+    // Calls the hooks in the order the executor calls them if fork fails.
+    bp::posix::executor e;
+    e.failed_stage = bp::posix::exec_stage_none;
+    init.on_fork_setup(e);
+    e.pid = -1;
+    errno = EAGAIN;
+    e.exec_failed(bp::posix::exec_stage_fork);
+    init.on_fork_error(e);
+    init.on_fork_success(e);
+    io_service.run();
+
+    BOOST_CHECK_EQUAL(1, calls);
+    BOOST_CHECK_EQUAL(EAGAIN, ec.value());
+}
+
+BOOST_AUTO_TEST_CASE(set_on_error_stage)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+    bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::start_in_dir("/doesnt-exist"),
+        bpi::on_exec_setup(no_op),
+        bpi::set_on_error(ec, stage)
+    );
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_chdir, stage);
+    ::waitpid(-1, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(set_on_error_stage_spawn)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    // posix_spawn doesn't tell which file action failed.
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::start_in_dir("/doesnt-exist"),
+        bpi::set_on_error(ec, stage)
+    );
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+#if defined(BOOST_PROCESS_POSIX_HAS_SPAWN_ADDCHDIR)
+    BOOST_CHECK_EQUAL(-1, c.pid);
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_spawn, stage);
+#else
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_chdir, stage);
+    bp::wait_for_exit(c);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(set_on_error_stage_setsid)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    // A process group leader can't create a new session.
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+    bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::new_process_group(),
+        bpi::new_session(),
+        bpi::on_exec_setup(no_op),
+        bpi::set_on_error(ec, stage)
+    );
+    BOOST_CHECK_EQUAL(EPERM, ec.value());
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_setsid, stage);
+    ::waitpid(-1, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(throw_on_error_stage)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    try
+    {
+        bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::start_in_dir("/doesnt-exist"),
+            bpi::on_exec_setup(no_op),
+            bpi::throw_on_error()
+        );
+        BOOST_ERROR("no exception thrown");
+    }
+    catch (boost::system::system_error &e)
+    {
+        BOOST_CHECK_EQUAL(ENOENT, e.code().value());
+        BOOST_CHECK(std::string(e.what()).find("chdir") != std::string::npos);
+    }
+    ::waitpid(-1, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(fork_server_stage)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bp::posix::fork_server server;
+    server.start();
+
+    boost::system::error_code ec;
+    bp::posix::exec_stage stage = bp::posix::exec_stage_none;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::start_in_dir("/doesnt-exist"),
+        bpi::via(server),
+        bpi::set_on_error(ec, stage)
+    );
+    BOOST_CHECK_EQUAL(-1, c.pid);
+    BOOST_CHECK_EQUAL(ENOENT, ec.value());
+    BOOST_CHECK_EQUAL(bp::posix::exec_stage_chdir, stage);
+}
+
+bp::child start_stdin_to_file(bp::pipe &p, FILE *file)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bio::file_descriptor_source source(p.source, bio::close_handle);
+    bio::file_descriptor_sink sink(::fileno(file), bio::never_close_handle);
+    return bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --stdin-to-stdout"),
+        bpi::bind_stdin(source),
+        bpi::bind_stdout(sink),
+        bpi::throw_on_error()
+    );
+}
+
+BOOST_AUTO_TEST_CASE(feed_stdin)
+{
+    std::string data(256 * 1024, 'x');
+    for (std::size_t i = 0; i < data.size(); i += 1000)
+        data[i] = 'a' + i % 26;
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_stdin_to_file(p, file);
+
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.push_back(boost::asio::buffer(data.data(), 1000));
+    buffers.push_back(boost::asio::buffer(data.data() + 1000,
+        data.size() - 1000));
+    BOOST_CHECK_EQUAL(data.size(), bp::posix::feed_stdin(p.sink, buffers));
+    ::close(p.sink);
+
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK(data == read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(feed_stdin_zero_copy)
+{
+    std::string data(256 * 1024, 'v');
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_stdin_to_file(p, file);
+
+    boost::system::error_code ec;
+    BOOST_CHECK_EQUAL(data.size(), bp::posix::feed_stdin(p.sink,
+        boost::asio::buffer(data), bp::posix::feed_zero_copy, ec));
+    BOOST_CHECK(!ec);
+    ::close(p.sink);
+
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK(data == read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(feed_stdin_gift)
+{
+    long page_size = ::sysconf(_SC_PAGESIZE);
+    std::size_t size = 16 * page_size;
+    void *pages = ::mmap(0, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    BOOST_REQUIRE(pages != MAP_FAILED);
+    std::memset(pages, 'g', size);
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_stdin_to_file(p, file);
+
+    boost::system::error_code ec;
+    BOOST_CHECK_EQUAL(size, bp::posix::feed_stdin(p.sink,
+        boost::asio::buffer(pages, size), bp::posix::feed_gift, ec));
+    BOOST_CHECK(!ec);
+    ::close(p.sink);
+
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK(std::string(size, 'g') == read_file(::fileno(file)));
+    std::fclose(file);
+    ::munmap(pages, size);
+}
+
+BOOST_AUTO_TEST_CASE(feed_stdin_write)
+{
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+
+    boost::system::error_code ec;
+    BOOST_CHECK_EQUAL(5u, bp::posix::feed_stdin(::fileno(file),
+        boost::asio::buffer("hello", 5), ec));
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(file)));
+
+    BOOST_CHECK_EQUAL(6u, bp::posix::feed_stdin(::fileno(file),
+        boost::asio::const_buffer(" world", 6), ec));
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL("hello world", read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(async_feed_stdin)
+{
+    std::string data(256 * 1024, 'y');
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bp::pipe p = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_stdin_to_file(p, file);
+
+    boost::asio::io_service io_service;
+    std::size_t total = 0;
+    bp::posix::async_feed_stdin(io_service, p.sink, boost::asio::buffer(data),
+        forward_handler(total));
+    io_service.run();
+    BOOST_CHECK_EQUAL(0, ::fcntl(p.sink, F_GETFL) & O_NONBLOCK);
+    ::close(p.sink);
+
+    BOOST_CHECK_EQUAL(data.size(), total);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK(data == read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+struct close_handler
+{
+    int fd_;
+    std::size_t &total_;
+
+    close_handler(int fd, std::size_t &total) : fd_(fd), total_(total) {}
+
+    void operator()(const boost::system::error_code &ec, std::size_t total)
+    {
+        BOOST_REQUIRE(!ec);
+        total_ = total;
+        ::close(fd_);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_forward_full_sink)
+{
+    std::string data(256 * 1024, 'z');
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bp::pipe in = bp::create_pipe(O_CLOEXEC);
+    bp::pipe out = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_stdin_to_file(out, file);
+
+    boost::asio::io_service io_service;
+    std::size_t fed = 0;
+    std::size_t forwarded = 0;
+    bp::posix::async_feed_stdin(io_service, in.sink,
+        boost::asio::buffer(data), close_handler(in.sink, fed));
+    bp::posix::async_forward(io_service, in.source, out.sink,
+        close_handler(out.sink, forwarded));
+    io_service.run();
+    BOOST_CHECK_EQUAL(0, ::fcntl(in.source, F_GETFL) & O_NONBLOCK);
+    ::close(in.source);
+
+    BOOST_CHECK_EQUAL(data.size(), fed);
+    BOOST_CHECK_EQUAL(data.size(), forwarded);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK(data == read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(bind_stdin_from_memory)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    std::string data(256 * 1024, 'm');
+    data[0] = 'a';
+    bpi::bind_stdin_from_memory stdin_data(boost::asio::buffer(data));
+
+    // The initializer can be used again.
+    for (int i = 0; i < 2; ++i)
+    {
+        FILE *file = std::tmpfile();
+        BOOST_REQUIRE(file);
+        bio::file_descriptor_sink sink(::fileno(file), bio::never_close_handle);
+        bp::child c = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --stdin-to-stdout"),
+            stdin_data,
+            bpi::bind_stdout(sink),
+            bpi::throw_on_error()
+        );
+        BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+        BOOST_CHECK(data == read_file(::fileno(file)));
+        std::fclose(file);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bind_stdin_from_memory_concurrent)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    std::string data(256 * 1024, 'n');
+    data[0] = 'a';
+    bpi::bind_stdin_from_memory stdin_data(boost::asio::buffer(data));
+
+    // Both child processes run at the same time and read all data, so
+    // they don't share an offset.
+    FILE *files[2];
+    bp::child children[2] = { bp::child(-1), bp::child(-1) };
+    for (int i = 0; i < 2; ++i)
+    {
+        files[i] = std::tmpfile();
+        BOOST_REQUIRE(files[i]);
+        bio::file_descriptor_sink sink(::fileno(files[i]),
+            bio::never_close_handle);
+        children[i] = bp::execute(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --stdin-to-stdout"),
+            stdin_data,
+            bpi::bind_stdout(sink),
+            bpi::throw_on_error()
+        );
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        BOOST_CHECK_EQUAL(EXIT_SUCCESS,
+            WEXITSTATUS(bp::wait_for_exit(children[i])));
+        BOOST_CHECK(data == read_file(::fileno(files[i])));
+        std::fclose(files[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bind_stdin_from_memory_no_reopen)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bpi::bind_stdin_from_memory stdin_data(boost::asio::buffer("hello", 5));
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bio::file_descriptor_sink sink(::fileno(file), bio::never_close_handle);
+
+    // No file descriptor can be opened, so /proc/self/fd/N can't be
+    // opened either and the memfd itself is bound.
+    int lowest = ::dup(STDIN_FILENO);
+    BOOST_REQUIRE(lowest != -1);
+    ::close(lowest);
+    rlimit old;
+    BOOST_REQUIRE_EQUAL(0, ::getrlimit(RLIMIT_NOFILE, &old));
+    rlimit limit = old;
+    limit.rlim_cur = lowest;
+    BOOST_REQUIRE_EQUAL(0, ::setrlimit(RLIMIT_NOFILE, &limit));
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --stdin-to-stdout"),
+        stdin_data,
+        bpi::bind_stdout(sink),
+        bpi::set_on_error(ec)
+    );
+    ::setrlimit(RLIMIT_NOFILE, &old);
+
+    BOOST_REQUIRE(!ec);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(bind_stdin_from_memory_file)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    FILE *input = std::tmpfile();
+    BOOST_REQUIRE(input);
+    BOOST_REQUIRE_EQUAL(5, ::write(::fileno(input), "hello", 5));
+    ::lseek(::fileno(input), 0, SEEK_SET);
+
+    boost::system::error_code ec;
+    bpi::bind_stdin_from_memory stdin_data(bio::file_descriptor_source(
+        ::fileno(input), bio::never_close_handle), ec);
+    BOOST_REQUIRE(!ec);
+    std::fclose(input);
+
+    FILE *file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    bio::file_descriptor_sink sink(::fileno(file), bio::never_close_handle);
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --stdin-to-stdout"),
+        stdin_data,
+        bpi::bind_stdout(sink),
+        bpi::on_exec_setup(no_op),
+        bpi::throw_on_error()
+    );
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+    BOOST_CHECK_EQUAL("hello", read_file(::fileno(file)));
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(capture_stdout_to_memory)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bpi::capture_stdout_to_memory output;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --echo-stdout hello"),
+        output,
+        bpi::throw_on_error()
+    );
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+
+    boost::asio::const_buffer b = output.buffer();
+    BOOST_CHECK_EQUAL("hello\n", std::string(
+        boost::asio::buffer_cast<const char*>(b),
+        boost::asio::buffer_size(b)));
+}
+
+BOOST_AUTO_TEST_CASE(capture_stdout_to_memory_empty)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bpi::capture_stdout_to_memory output(ec);
+    BOOST_REQUIRE(!ec);
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 0"),
+        output,
+        bpi::on_exec_setup(no_op),
+        bpi::throw_on_error()
+    );
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(bp::wait_for_exit(c)));
+
+    BOOST_CHECK_EQUAL(0u, boost::asio::buffer_size(output.buffer(ec)));
+    BOOST_CHECK(!ec);
+}
+
+bp::child start_communicating(const std::string &args, bp::pipe &in,
+    bp::pipe &out, bp::pipe &err)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    bio::file_descriptor_source source(in.source, bio::close_handle);
+    bio::file_descriptor_sink out_sink(out.sink, bio::close_handle);
+    bio::file_descriptor_sink err_sink(err.sink, bio::close_handle);
+    return bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test " + args),
+        bpi::bind_stdin(source),
+        bpi::bind_stdout(out_sink),
+        bpi::bind_stderr(err_sink),
+        bpi::throw_on_error()
+    );
+}
+
+BOOST_AUTO_TEST_CASE(communicate)
+{
+    // Both directions exceed the pipe capacity.
+    std::string input(256 * 1024, 'c');
+    input[0] = 'a';
+
+    bp::pipe in = bp::create_pipe(O_CLOEXEC);
+    bp::pipe out = bp::create_pipe(O_CLOEXEC);
+    bp::pipe err = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_communicating("--stdin-to-stdout", in, out, err);
+
+    std::string output, error;
+    int status = bp::posix::communicate(c, in.sink,
+        boost::asio::buffer(input), out.source, output, err.source, error);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+    BOOST_CHECK(input == output);
+    BOOST_CHECK(error.empty());
+}
+
+BOOST_AUTO_TEST_CASE(communicate_unread_input)
+{
+    std::string input(1024 * 1024, 'c');
+
+    bp::pipe in = bp::create_pipe(O_CLOEXEC);
+    bp::pipe out = bp::create_pipe(O_CLOEXEC);
+    bp::pipe err = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_communicating("--echo-stdout-stderr hello", in, out,
+        err);
+
+    std::string output, error;
+    boost::system::error_code ec;
+    int status = bp::posix::communicate(c, in.sink,
+        boost::asio::buffer(input), out.source, output, err.source, error,
+        ec);
+    BOOST_CHECK(!ec);
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+    BOOST_CHECK_EQUAL("hello\n", output);
+    BOOST_CHECK_EQUAL("hello\n", error);
+}
+
+struct communicate_handler
+{
+    int &status_;
+
+    communicate_handler(int &status) : status_(status) {}
+
+    void operator()(const boost::system::error_code &ec, int status)
+    {
+        BOOST_REQUIRE(!ec);
+        status_ = status;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_communicate)
+{
+    std::string input(256 * 1024, 'c');
+
+    bp::pipe in = bp::create_pipe(O_CLOEXEC);
+    bp::pipe out = bp::create_pipe(O_CLOEXEC);
+    bp::pipe err = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_communicating("--stdin-to-stdout", in, out, err);
+
+    boost::asio::io_service io_service;
+    std::string output, error;
+    int status = -1;
+    bp::posix::async_communicate(io_service, c, in.sink,
+        boost::asio::buffer(input), out.source, output, err.source, error,
+        communicate_handler(status));
+    io_service.run();
+
+    BOOST_CHECK_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+    BOOST_CHECK(input == output);
+    BOOST_CHECK(error.empty());
+}
+
+struct communicate_error_handler
+{
+    boost::system::error_code &ec_;
+
+    communicate_error_handler(boost::system::error_code &ec) : ec_(ec) {}
+
+    void operator()(const boost::system::error_code &ec, int)
+    {
+        ec_ = ec;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(async_communicate_error)
+{
+    std::string input(256 * 1024, 'c');
+
+    bp::pipe in = bp::create_pipe(O_CLOEXEC);
+    bp::pipe out = bp::create_pipe(O_CLOEXEC);
+    bp::pipe err = bp::create_pipe(O_CLOEXEC);
+    bp::child c = start_communicating("--stdin-to-stdout", in, out, err);
+    ::close(err.source);
+
+    // /dev/null can't be registered with the I/O service.
+    int write_only = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    BOOST_REQUIRE(write_only != -1);
+
+    boost::asio::io_service io_service;
+    std::string output, error;
+    boost::system::error_code ec;
+    bp::posix::async_communicate(io_service, c, in.sink,
+        boost::asio::buffer(input), out.source, output, write_only, error,
+        communicate_error_handler(ec));
+    io_service.run();
+
+    BOOST_CHECK(ec);
+    // The child process has been reaped.
+    BOOST_CHECK_EQUAL(-1, ::waitpid(c.pid, 0, WNOHANG));
+    BOOST_CHECK_EQUAL(ECHILD, errno);
+}
+
+struct run_handler
+{
+    std::vector<bp::posix::run_result> &results_;
+    std::vector<boost::system::error_code> &errors_;
+
+    run_handler(std::vector<bp::posix::run_result> &results,
+        std::vector<boost::system::error_code> &errors)
+        : results_(results), errors_(errors) {}
+
+    void operator()(const boost::system::error_code &ec,
+        const bp::posix::run_result &r)
+    {
+        results_.push_back(r);
+        errors_.push_back(ec);
+    }
+};
+
+std::string to_string(const boost::asio::const_buffer &b)
+{
+    return std::string(boost::asio::buffer_cast<const char*>(b),
+        boost::asio::buffer_size(b));
+}
+
+BOOST_AUTO_TEST_CASE(async_run)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    std::vector<bp::posix::run_result> results;
+    std::vector<boost::system::error_code> errors;
+    for (int i = 0; i < 20; ++i)
+    {
+        bp::posix::async_run(io_service,
+            boost::fusion::make_vector(
+                bpi::run_exe(master_test_suite().argv[1]),
+                bpi::set_cmd_line("test --echo-stdout-stderr hello")),
+            bp::posix::capture_stdout | bp::posix::capture_stderr,
+            run_handler(results, errors));
+    }
+    io_service.run();
+
+    BOOST_REQUIRE_EQUAL(20u, results.size());
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        BOOST_CHECK(!errors[i]);
+        BOOST_CHECK_EQUAL(EXIT_SUCCESS, results[i].info.exit_code);
+        BOOST_CHECK_EQUAL("hello\n", to_string(results[i].out));
+        BOOST_CHECK_EQUAL("hello\n", to_string(results[i].err));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(async_run_stdout_only)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    std::vector<bp::posix::run_result> results;
+    std::vector<boost::system::error_code> errors;
+    bp::posix::async_run(io_service,
+        boost::fusion::make_vector(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --exit-code 3"),
+            bpi::on_exec_setup(no_op)),
+        bp::posix::capture_stdout,
+        run_handler(results, errors));
+    io_service.run();
+
+    BOOST_REQUIRE_EQUAL(1u, results.size());
+    BOOST_CHECK(!errors[0]);
+    BOOST_CHECK_EQUAL(3, results[0].info.exit_code);
+    BOOST_CHECK(results[0].out_memory);
+    BOOST_CHECK(!results[0].err_memory);
+    BOOST_CHECK_EQUAL(0u, boost::asio::buffer_size(results[0].out));
+    BOOST_CHECK_EQUAL(0u, boost::asio::buffer_size(results[0].err));
+}
+
+BOOST_AUTO_TEST_CASE(async_run_error)
+{
+    boost::asio::io_service io_service;
+    std::vector<bp::posix::run_result> results;
+    std::vector<boost::system::error_code> errors;
+    bp::posix::async_run(io_service,
+        boost::fusion::make_vector(bpi::run_exe("/doesnt-exist")),
+        run_handler(results, errors));
+    io_service.run();
+
+    BOOST_REQUIRE_EQUAL(1u, errors.size());
+    BOOST_CHECK_EQUAL(ENOENT, errors[0].value());
+}
+
+BOOST_AUTO_TEST_CASE(async_run_binds_stdout)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::asio::io_service io_service;
+    std::vector<bp::posix::run_result> results;
+    std::vector<boost::system::error_code> errors;
+    bp::posix::async_run(io_service,
+        boost::fusion::make_vector(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout-stderr hello"),
+            bpi::close_stdout()),
+        bp::posix::capture_stdout | bp::posix::capture_stderr,
+        run_handler(results, errors));
+    bp::posix::async_run(io_service,
+        boost::fusion::make_vector(
+            bpi::run_exe(master_test_suite().argv[1]),
+            bpi::set_cmd_line("test --echo-stdout-stderr hello"),
+            bpi::close_stdout()),
+        bp::posix::capture_stderr,
+        run_handler(results, errors));
+    io_service.run();
+
+    BOOST_REQUIRE_EQUAL(2u, errors.size());
+    BOOST_CHECK_EQUAL(EINVAL, errors[0].value());
+    BOOST_CHECK(!errors[1]);
+    BOOST_CHECK_EQUAL("hello\n", to_string(results[1].err));
+}
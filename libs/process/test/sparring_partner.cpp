@@ -24,6 +24,7 @@
 #   include <boost/iostreams/device/file_descriptor.hpp>
 #   include <boost/iostreams/stream.hpp>
 #   include <unistd.h>
+#   include <fcntl.h>
 #elif defined(BOOST_WINDOWS_API)
 #   include <Windows.h>
 #endif
@@ -54,7 +55,8 @@ int main(int argc, char *argv[])
         ("stdin-to-stdout", bool_switch())
 #if defined(BOOST_POSIX_API)
         ("posix-echo-one", value<std::vector<std::string> >()->multitoken())
-        ("posix-echo-two", value<std::vector<std::string> >()->multitoken());
+        ("posix-echo-two", value<std::vector<std::string> >()->multitoken())
+        ("posix-is-closed-fd", value<int>());
 #elif defined(BOOST_WINDOWS_API)
         ("windows-print-showwindow", bool_switch())
         ("windows-print-flags", bool_switch());
@@ -214,6 +216,11 @@ int main(int argc, char *argv[])
         stream<file_descriptor_sink> os2(sink2);
         os2 << v[3] << std::endl;
     }
+    else if (vm.count("posix-is-closed-fd"))
+    {
+        int fd = vm["posix-is-closed-fd"].as<int>();
+        return fcntl(fd, F_GETFD) == -1 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 #elif defined(BOOST_WINDOWS_API)
     else if (vm["windows-print-showwindow"].as<bool>())
     {
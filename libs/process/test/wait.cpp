@@ -13,7 +13,12 @@
 #include <boost/process.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/asio.hpp>
-#if defined(BOOST_POSIX_API)
+#include <boost/chrono/duration.hpp>
+#include <boost/optional.hpp>
+#if defined(BOOST_WINDOWS_API)
+#   include <Windows.h>
+#elif defined(BOOST_POSIX_API)
+#   include <sys/wait.h>
 #   include <signal.h>
 #endif
 
@@ -35,6 +40,23 @@ BOOST_AUTO_TEST_CASE(sync_wait)
     bp::wait_for_exit(c);
 }
 
+BOOST_AUTO_TEST_CASE(sync_wait_for)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --wait 1"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    BOOST_CHECK(!bp::wait_for_exit_for(c, boost::chrono::milliseconds(10)));
+    BOOST_CHECK(bp::wait_for_exit_for(c, boost::chrono::seconds(10), ec));
+    BOOST_CHECK(!ec);
+}
+
 struct wait_handler
 {
 #if defined(BOOST_WINDOWS_API)
@@ -44,6 +66,48 @@ struct wait_handler
 #endif
 };
 
+struct exit_code_handler
+{
+    int &exit_code_;
+
+    exit_code_handler(int &exit_code) : exit_code_(exit_code) {}
+
+#if defined(BOOST_WINDOWS_API)
+    void operator()(const boost::system::error_code &ec, DWORD exit_code)
+    {
+        BOOST_REQUIRE(!ec);
+        exit_code_ = static_cast<int>(exit_code);
+    }
+#elif defined(BOOST_POSIX_API)
+    void operator()(const boost::system::error_code &ec, int status)
+    {
+        BOOST_REQUIRE(!ec);
+        exit_code_ = WEXITSTATUS(status);
+    }
+#endif
+};
+
+BOOST_AUTO_TEST_CASE(async_wait_for_exit)
+{
+    using boost::unit_test::framework::master_test_suite;
+
+    boost::system::error_code ec;
+    bp::child c = bp::execute(
+        bpi::run_exe(master_test_suite().argv[1]),
+        bpi::set_cmd_line("test --exit-code 123"),
+        bpi::set_on_error(ec)
+    );
+    BOOST_REQUIRE(!ec);
+
+    boost::asio::io_service io_service;
+
+    int exit_code = 0;
+    bp::async_wait_for_exit(io_service, c, exit_code_handler(exit_code));
+
+    io_service.run();
+    BOOST_CHECK_EQUAL(123, exit_code);
+}
+
 BOOST_AUTO_TEST_CASE(async_wait)
 {
     using boost::unit_test::framework::master_test_suite;